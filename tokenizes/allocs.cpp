@@ -0,0 +1,83 @@
+#include "allocs.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+namespace tokenizes::allocs {
+
+namespace {
+
+std::atomic<uint64_t> process_allocations{0}, process_bytes{0};
+// trivially constructible, so reading them from operator new never allocates
+thread_local uint64_t thread_allocations = 0, thread_bytes = 0;
+
+void count(size_t size) {
+    thread_allocations++, thread_bytes += size;
+    process_allocations.fetch_add(1, std::memory_order_relaxed);
+    process_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void *allocate(size_t size) {
+    count(size);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void *allocate(size_t size, std::align_val_t align) {
+    count(size);
+    const size_t alignment = static_cast<size_t>(align);
+    // aligned_alloc wants a multiple of the alignment
+    const size_t rounded = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void *p = std::aligned_alloc(alignment, rounded)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+allocation_counts thread_counts() { return {thread_allocations, thread_bytes}; }
+
+allocation_counts process_counts() {
+    return {process_allocations.load(std::memory_order_relaxed), process_bytes.load(std::memory_order_relaxed)};
+}
+
+} // namespace tokenizes::allocs
+
+using tokenizes::allocs::allocate;
+
+void *operator new(size_t size) { return allocate(size); }
+void *operator new[](size_t size) { return allocate(size); }
+void *operator new(size_t size, std::align_val_t align) { return allocate(size, align); }
+void *operator new[](size_t size, std::align_val_t align) { return allocate(size, align); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void *operator new(size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    try {
+        return allocate(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void *operator new[](size_t size, std::align_val_t align, const std::nothrow_t &tag) noexcept {
+    return operator new(size, align, tag);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+namespace tokenizes::allocs {
+
+/** heap allocations made through the global operator new
+ * the tokenize_allocs library replaces the global operator new and delete of the executable it is linked into;
+ * every form of new is counted, per thread and for the whole process.
+ */
+struct allocation_counts {
+    uint64_t allocations{0}, bytes{0};
+
+    allocation_counts operator-(const allocation_counts &x) const { return {allocations - x.allocations, bytes - x.bytes}; }
+};
+
+// made by the calling thread so far
+allocation_counts thread_counts();
+// made by every thread so far
+allocation_counts process_counts();
+
+// allocations of the calling thread while it lives
+class counting_scope {
+    allocation_counts begin;
+
+public:
+    counting_scope() : begin(thread_counts()) {}
+    allocation_counts counts() const { return thread_counts() - begin; }
+};
+
+} // namespace tokenizes::allocs
@@ -0,0 +1,103 @@
+#include "allocs.hpp"
+#include "combinators.hpp"
+#include "corpora.hpp"
+#include "primitive.hpp"
+#include "tokens.hpp"
+
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace tokenizes::allocs;
+using tokenizes::corpora::corpus_generator;
+using tokenizes::tokens::token_context;
+using tokenizes::tokens::token_id;
+using tokenizes::tokens::token_parser;
+
+namespace allocs_tests {
+
+TEST(counting_scope, counts_the_calling_thread) {
+    const counting_scope scope;
+    auto p = std::make_unique<std::vector<int>>(100);
+    EXPECT_EQ(scope.counts().allocations, 2);
+    EXPECT_GE(scope.counts().bytes, sizeof(std::vector<int>) + 100 * sizeof(int));
+    EXPECT_GE(process_counts().allocations, scope.counts().allocations);
+}
+
+TEST(counting_scope, counts_aligned_new) {
+    struct alignas(64) line {
+        char bytes[64];
+    };
+    const counting_scope scope;
+    auto p = std::make_unique<line>();
+    EXPECT_EQ(scope.counts().allocations, 1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p.get()) % 64, 0);
+}
+
+// once its buffers are warm, a token_context tokenizes without touching the heap
+TEST(steady_state, token_context_does_not_allocate) {
+    // values of up to 15 characters fit std::string's inline buffer
+    const std::string text = corpus_generator({.seed = 11, .max_text = 15, .max_identifier = 15}).generate(1 << 16);
+    const token_parser parser;
+    token_context context;
+    ASSERT_TRUE(parser.tokenize(text, context).is_right());
+
+    const counting_scope scope;
+    for (int round = 0; round < 3; round++) {
+        ASSERT_TRUE(parser.tokenize(text, context).is_right());
+    }
+    EXPECT_EQ(scope.counts().allocations, 0);
+    EXPECT_EQ(scope.counts().bytes, 0);
+}
+
+TEST(steady_state, long_texts_allocate_their_value_once) {
+    const std::string text = "'a text literal longer than the inline buffer' x \"and another one of those\"";
+    const token_parser parser;
+    token_context context;
+    ASSERT_TRUE(parser.tokenize(text, context).is_right());
+
+    const counting_scope scope;
+    const auto tokens = parser.tokenize(text, context);
+    ASSERT_TRUE(tokens.is_right());
+    ASSERT_EQ(tokens.get_right().size(), 3);
+    EXPECT_EQ(tokens.get_right()[0].id, token_id::text);
+    EXPECT_EQ(scope.counts().allocations, 2);
+}
+
+TEST(steady_state, arena_tokenize_stays_off_the_heap) {
+    const std::string text = "'a text literal longer than the inline buffer' x \"and another one of those\"";
+    const token_parser parser;
+    token_context context;
+    ASSERT_TRUE(parser.tokenize(text, context).is_right());
+
+    alignas(std::max_align_t) char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    const counting_scope scope;
+    const auto tokens = parser.tokenize(text, context, &arena);
+    ASSERT_TRUE(tokens.is_right());
+    ASSERT_EQ(tokens.get_right().size(), 3);
+    EXPECT_EQ(scope.counts().allocations, 0);
+}
+
+TEST(steady_state, combinators_do_not_allocate) {
+    using tokenizes::combinators::operator+;
+    using tokenizes::combinators::operator*;
+    using tokenizes::primitive::tag;
+    const auto parser = (tag("if") + tag("in")) * tag(" ") * tag("x");
+    std::istringstream ss("in x");
+    ASSERT_TRUE(parser(ss).is_right());
+
+    const counting_scope scope;
+    for (int round = 0; round < 100; round++) {
+        ss.clear();
+        ss.seekg(0);
+        ASSERT_TRUE(parser(ss).is_right());
+    }
+    EXPECT_EQ(scope.counts().allocations, 0);
+}
+
+} // namespace allocs_tests
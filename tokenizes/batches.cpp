@@ -0,0 +1,55 @@
+#include "batches.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+namespace tokenizes::batches {
+
+using tokenizes::eithers::left;
+
+size_t token_batch::failures() const {
+    return std::count_if(results.begin(), results.end(), [](const auto &r) { return r->is_left(); });
+}
+
+token_batch tokenize_batch(const token_parser &parser, std::span<const std::string_view> documents, size_t chunk) {
+#ifdef _OPENMP
+    const int workers = omp_get_max_threads();
+#else
+    const int workers = 1;
+#endif
+    const int step = static_cast<int>(std::max<size_t>(chunk, 1));
+    const auto n = static_cast<std::ptrdiff_t>(documents.size());
+
+    token_batch batch;
+    for (int i = 0; i < workers; i++) {
+        batch.arenas.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>(token_batch::arena_size));
+    }
+    batch.results.resize(documents.size());
+
+#pragma omp parallel num_threads(workers)
+    {
+#ifdef _OPENMP
+        std::pmr::memory_resource *arena = batch.arenas[omp_get_thread_num()].get();
+#else
+        std::pmr::memory_resource *arena = batch.arenas[0].get();
+#endif
+        tokens::token_context context;
+
+#pragma omp for schedule(dynamic, step)
+        for (std::ptrdiff_t i = 0; i < n; i++) {
+            // an exception leaving the parallel region would terminate the process
+            try {
+                batch.results[i].emplace(parser.tokenize(documents[i], context, arena));
+            } catch (const std::exception &e) {
+                batch.results[i].emplace(left(std::string(e.what())));
+            } catch (...) {
+                batch.results[i].emplace(left(std::string("unknown exception")));
+            }
+        }
+    }
+    return batch;
+}
+
+} // namespace tokenizes::batches
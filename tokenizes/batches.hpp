@@ -0,0 +1,51 @@
+#pragma once
+#include "either.hpp"
+#include "tokens.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace tokenizes::batches {
+
+using tokenizes::eithers::either;
+using tokenizes::tokens::token;
+using tokenizes::tokens::token_parser;
+
+/** tokens of many documents, in input order
+ * each worker allocates the tokens it produces from its own arena, owned by the batch,
+ * so results live as long as the batch and are released together.
+ */
+class token_batch {
+public:
+    using result = either<std::pmr::vector<token>, std::string>;
+    constexpr static size_t arena_size = 64 * 1024;
+
+private:
+    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> arenas;
+    std::vector<std::optional<result>> results;
+
+    friend token_batch tokenize_batch(const token_parser &, std::span<const std::string_view>, size_t);
+
+public:
+    size_t size() const { return results.size(); }
+    const result &operator[](size_t i) const { return *results[i]; }
+    // documents that failed to tokenize
+    size_t failures() const;
+    size_t workers() const { return arenas.size(); }
+};
+
+/** tokenizes documents in parallel with one shared parser
+ * documents are handed out dynamically, chunk at a time, to OpenMP workers (or run serially without OpenMP).
+ * a worker keeps one token_context and one arena for the whole batch,
+ * so a small document costs no stream, locale or vector setup of its own.
+ * a document whose tokenizing throws (e.g. an arena out of memory) gets the exception's message as its error,
+ * or "unknown exception" when what was thrown is not a std::exception.
+ */
+token_batch tokenize_batch(const token_parser &parser, std::span<const std::string_view> documents,
+                           size_t chunk = 16);
+
+} // namespace tokenizes::batches
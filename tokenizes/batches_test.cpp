@@ -0,0 +1,100 @@
+#include "batches.hpp"
+#include "tokens.hpp"
+
+#include "gtest/gtest.h"
+#include <memory_resource>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace tokenizes::batches;
+using tokenizes::tokens::message_of;
+using tokenizes::tokens::token_errors;
+
+namespace batches_tests {
+
+TEST(tokenize_batch, input_order) {
+    const token_parser parser;
+    std::vector<std::string> texts;
+    for (int i = 0; i < 500; i++) {
+        texts.push_back("x" + std::to_string(i) + " = " + std::to_string(i) + " * 'v'");
+    }
+    texts[123] = "1 $";
+    const std::vector<std::string_view> documents(texts.begin(), texts.end());
+
+    const token_batch batch = tokenize_batch(parser, documents, 7);
+    ASSERT_EQ(batch.size(), texts.size());
+    EXPECT_EQ(batch.failures(), 1);
+    EXPECT_GE(batch.workers(), 1);
+
+    for (size_t i = 0; i < texts.size(); i++) {
+        std::stringstream ss(texts[i]);
+        const auto expected = parser.tokenize(ss);
+        ASSERT_EQ(batch[i].is_right(), expected.is_right()) << i;
+        if (expected.is_left()) {
+            EXPECT_EQ(batch[i].get_left(), message_of(token_errors::unexpected_character));
+            continue;
+        }
+        const auto &tokens = batch[i].get_right();
+        ASSERT_EQ(tokens.size(), expected.get_right().size()) << i;
+        for (size_t j = 0; j < tokens.size(); j++) {
+            EXPECT_EQ(tokens[j].id, expected.get_right()[j].id);
+            EXPECT_EQ(tokens[j].value, expected.get_right()[j].value);
+            EXPECT_EQ(tokens[j].pos.begin, expected.get_right()[j].pos.begin);
+        }
+    }
+}
+
+TEST(tokenize_batch, empty) {
+    const token_parser parser;
+    const token_batch batch = tokenize_batch(parser, {});
+    EXPECT_EQ(batch.size(), 0);
+    EXPECT_EQ(batch.failures(), 0);
+}
+
+TEST(tokenize_batch, outlives_moves) {
+    const token_parser parser;
+    const std::vector<std::string_view> documents{"a + 1", "'text that does not fit inline'"};
+    token_batch moved = tokenize_batch(parser, documents);
+    const token_batch batch = std::move(moved);
+    ASSERT_TRUE(batch[1].is_right());
+    EXPECT_EQ(batch[1].get_right()[0].value,
+              tokenizes::tokens::value_t(tokenizes::tokens::text_t("text that does not fit inline")));
+}
+
+TEST(tokenize_batch, exceptions_become_errors) {
+    const token_parser parser;
+    const std::vector<std::string_view> documents{"a + 1", ""};
+    // the worker arenas draw on the default resource, which now refuses every allocation
+    std::pmr::memory_resource *previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    const token_batch batch = tokenize_batch(parser, documents);
+    std::pmr::set_default_resource(previous);
+
+    ASSERT_EQ(batch.size(), 2);
+    ASSERT_TRUE(batch[0].is_left());
+    EXPECT_EQ(batch[0].get_left(), std::bad_alloc().what());
+    EXPECT_TRUE(batch[1].is_right());
+    EXPECT_EQ(batch.failures(), 1);
+}
+
+// throws something that is not a std::exception
+class throwing_resource : public std::pmr::memory_resource {
+    void *do_allocate(size_t, size_t) override { throw 42; }
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const memory_resource &x) const noexcept override { return this == &x; }
+};
+
+TEST(tokenize_batch, unknown_exceptions_become_errors) {
+    const token_parser parser;
+    const std::vector<std::string_view> documents{"a + 1"};
+    throwing_resource throwing;
+    std::pmr::memory_resource *previous = std::pmr::set_default_resource(&throwing);
+    const token_batch batch = tokenize_batch(parser, documents);
+    std::pmr::set_default_resource(previous);
+
+    ASSERT_TRUE(batch[0].is_left());
+    EXPECT_EQ(batch[0].get_left(), "unknown exception");
+}
+
+} // namespace batches_tests
@@ -0,0 +1,100 @@
+#pragma once
+#include "allocs.hpp"
+#include "perfs.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+namespace tokenizes::benches {
+
+/** space separated items drawn from make(random), at least size bytes
+ * the seed is fixed, so every run sees the same corpus.
+ */
+template <class F>
+std::string items(size_t size, F make) {
+    std::mt19937 random(0);
+    std::string text;
+    text.reserve(size + 64);
+    while (text.size() < size) {
+        text += make(random);
+        text += ' ';
+    }
+    return text;
+}
+
+template <size_t N>
+std::string pick(std::mt19937 &random, const char *const (&words)[N]) {
+    return words[random() % N];
+}
+
+/** heap allocations and bytes per unit made by the calling thread while scope lived
+ * e.g. allocs/token and bytes/token; threaded benchmarks report the average over threads.
+ */
+inline void allocation_counters(benchmark::State &state, const allocs::counting_scope &scope, double units,
+                                const std::string &unit) {
+    const allocs::allocation_counts used = scope.counts();
+    const double per = units > 0 ? 1 / units : 0;
+    state.counters["allocs/" + unit] = benchmark::Counter(used.allocations * per, benchmark::Counter::kAvgThreads);
+    state.counters["bytes/" + unit] = benchmark::Counter(used.bytes * per, benchmark::Counter::kAvgThreads);
+}
+
+/** hardware counters over bytes and units (tokens, items): cycles/byte, IPC and each event per unit
+ * without perf events the benchmark keeps its wall-clock figures and is labelled so.
+ */
+inline void hardware_counters(benchmark::State &state, const perfs::perf_sample &used, double bytes, double units,
+                              const std::string &unit) {
+    using perfs::perf_event;
+    bool any = false;
+    for (const perf_event event : {perf_event::cycles, perf_event::instructions, perf_event::branch_misses,
+                                   perf_event::cache_misses}) {
+        if (!used[event] || units <= 0) continue;
+        any = true;
+        state.counters[std::string(perfs::name_of(event)) + "/" + unit] =
+            benchmark::Counter(*used[event] / units, benchmark::Counter::kAvgThreads);
+    }
+    if (used[perf_event::cycles] && bytes > 0) {
+        state.counters["cycles/byte"] = benchmark::Counter(*used[perf_event::cycles] / bytes, benchmark::Counter::kAvgThreads);
+    }
+    if (const auto ipc = used.ipc()) {
+        state.counters["IPC"] = benchmark::Counter(*ipc, benchmark::Counter::kAvgThreads);
+    }
+    if (!any) {
+        state.SetLabel("no perf counters");
+    }
+}
+
+/** applies parser to text item after item, consuming one separator in between
+ * reports bytes/s, items/s, allocations and hardware counters per item; a corpus the parser cannot read to the end is an error.
+ */
+template <class P>
+void run_items(benchmark::State &state, const P &parser, const std::string &text) {
+    std::stringstream ss(text);
+    size_t count = 0;
+    const allocs::counting_scope allocations;
+    const perfs::perf_counters counters;
+    const perfs::perf_sample begin = counters.sample();
+    for (auto _ : state) {
+        ss.clear();
+        ss.seekg(0);
+        for (;;) {
+            auto e = parser(ss);
+            if (e.is_left()) break;
+            benchmark::DoNotOptimize(e);
+            count++;
+            if (ss.get() == -1) break;
+        }
+        if (ss.peek() != -1) {
+            state.SkipWithError("parser stopped before the end of the corpus");
+            return;
+        }
+    }
+    const perfs::perf_sample used = counters.sample() - begin;
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["items"] = benchmark::Counter(count, benchmark::Counter::kIsRate);
+    allocation_counters(state, allocations, count, "item");
+    hardware_counters(state, used, static_cast<double>(state.iterations()) * text.size(), count, "item");
+}
+
+} // namespace tokenizes::benches
@@ -1,15 +1,26 @@
 #pragma once
 #include "concepts.hpp"
+#include "cuts.hpp"
 #include "either.hpp"
+#include "firsts.hpp"
+#include "inputs.hpp"
+#include "primitive.hpp"
+#include "probes.hpp"
+#include "smalls.hpp"
+#include <array>
+#include <bitset>
 #include <cstddef>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace tokenizes::combinators {
 using tokenizes::concepts::either_of;
+using tokenizes::concepts::input_of;
 using tokenizes::concepts::left_of;
 using tokenizes::concepts::parsable;
 using tokenizes::concepts::right_of;
@@ -32,12 +43,12 @@ std::tuple<X, Y> typed_merge(X &&x, Y &&y) {
 
 template <class... X, class Y>
 std::tuple<X..., Y> typed_merge(std::tuple<X...> &&x, Y &&y) {
-    return std::tuple_cat(std::move(x), std::make_tuple(y));
+    return std::tuple_cat(std::move(x), std::make_tuple(std::move(y)));
 }
 
 template <class X, class... Y>
 std::tuple<X, Y...> typed_merge(X &&x, std::tuple<Y...> &&y) {
-    return std::tuple_cat(std::make_tuple(x), std::move(y));
+    return std::tuple_cat(std::make_tuple(std::move(x)), std::move(y));
 }
 
 template <class... X, class... Y>
@@ -55,27 +66,31 @@ std::tuple<X..., Y...> typed_merge(std::tuple<X...> &&x, std::tuple<Y...> &&y) {
 template <class X, class Y>
     requires std::same_as<X, Y>
 std::vector<X> typed_merge(X &&x, Y &&y) {
-    return {x, y};
+    std::vector<X> result;
+    result.reserve(2);
+    result.push_back(std::move(x));
+    result.push_back(std::move(y));
+    return result;
 }
 
 template <class X, class Y>
     requires std::same_as<X, Y>
 std::vector<X> typed_merge(std::vector<X> &&x, Y &&y) {
-    x.push_back(y);
+    x.push_back(std::move(y));
     return x;
 }
 
 template <class X, class Y>
     requires std::same_as<X, Y>
 std::vector<X> typed_merge(X &&x, std::vector<Y> &&y) {
-    y.insert(y.begin(), x);
+    y.insert(y.begin(), std::move(x));
     return y;
 }
 
 template <class X, class Y>
     requires std::same_as<X, Y>
 std::vector<X> typed_merge(std::vector<X> &&x, std::vector<Y> &&y) {
-    x.insert(x.end(), y.begin(), y.end());
+    x.insert(x.end(), std::make_move_iterator(y.begin()), std::make_move_iterator(y.end()));
     return x;
 }
 
@@ -89,7 +104,7 @@ std::vector<X> typed_merge(std::vector<X> &&x, std::vector<Y> &&y) {
 static inline std::string typed_merge(char x, char y) { return {x, y}; }
 
 static inline std::string typed_merge(std::string &&x, char y) {
-    x.push_back(y);
+    x.push_back(std::move(y));
     return x;
 }
 
@@ -103,6 +118,56 @@ static inline std::string typed_merge(std::string &&x, std::string &&y) {
     return x;
 }
 
+/** small container version
+ * small_vector<T, N> merges as vector<T>, small_string<N> as string:
+ * (small, T | [T] | small) -> [T], (T | [T], small) -> [T], likewise with char and string.
+ */
+
+template <class X>
+struct is_small : std::false_type {};
+
+template <class T, size_t N>
+struct is_small<smalls::small_vector<T, N>> : std::true_type {};
+
+template <size_t N>
+struct is_small<smalls::small_string<N>> : std::true_type {};
+
+template <class X>
+concept small_container = is_small<std::remove_cvref_t<X>>::value;
+
+template <class X>
+X large_of(X &&x) {
+    return std::move(x);
+}
+
+template <class T, size_t N>
+std::vector<T> large_of(smalls::small_vector<T, N> &&x) {
+    return std::vector<T>(std::make_move_iterator(x.begin()), std::make_move_iterator(x.end()));
+}
+
+template <size_t N>
+std::string large_of(smalls::small_string<N> &&x) {
+    return x.str();
+}
+
+template <class X, class Y>
+concept small_merge = (small_container<X> || small_container<Y>) && requires(X &&x, Y &&y) {
+    typed_merge(large_of(std::move(x)), large_of(std::move(y)));
+};
+
+template <class X, class Y>
+    requires small_merge<X, Y>
+auto typed_merge(X &&x, Y &&y) {
+    return typed_merge(large_of(std::move(x)), large_of(std::move(y)));
+}
+
+// (small, small) of one type: also a candidate for the T,T -> [T] rule above
+template <class X, class Y>
+    requires std::same_as<X, Y> && small_merge<X, Y>
+auto typed_merge(X &&x, Y &&y) {
+    return typed_merge(large_of(std::move(x)), large_of(std::move(y)));
+}
+
 /** nullptr version
  * (nullptr,T      ) -> T
  * (T,      nullptr) -> T
@@ -112,78 +177,218 @@ static inline std::string typed_merge(std::string &&x, std::string &&y) {
 template <class T>
 static inline T typed_merge(T &&x, std::nullptr_t y) {
     (void)y;
-    return x;
+    return std::move(x);
 }
 
 template <class T>
 static inline T typed_merge(std::nullptr_t x, T &&y) {
     (void)x;
-    return y;
+    return std::move(y);
 }
 
 static inline std::nullptr_t typed_merge(std::nullptr_t x, std::nullptr_t y) { return nullptr; }
 
-template <parsable PX, parsable PY>
-    requires std::same_as<left_of<PX>, left_of<PY>>
+template <class... X>
+static inline std::tuple<X...> typed_merge(std::tuple<X...> &&x, std::nullptr_t y) {
+    (void)y;
+    return std::move(x);
+}
+
+template <class... Y>
+static inline std::tuple<Y...> typed_merge(std::nullptr_t x, std::tuple<Y...> &&y) {
+    (void)x;
+    return std::move(y);
+}
+
+/** variadic version
+ * merged_t is the left fold of typed_merge over the parts.
+ * typed_concat builds that result once instead of merging pairwise:
+ * a tuple by a single tuple_cat, a vector or string reserved and appended in order.
+ * mixes that do not fold associatively (e.g. T,T,(Y...)) fall back to the pairwise merge.
+ */
+
+template <class X, class... Y>
+struct merged {
+    using type = X;
+};
+
+template <class X, class Y, class... Z>
+struct merged<X, Y, Z...> {
+    using type = typename merged<decltype(typed_merge(std::declval<X>(), std::declval<Y>())), Z...>::type;
+};
+
+template <class... X>
+using merged_t = typename merged<X...>::type;
+
+template <class T>
+struct is_tuple : std::false_type {};
+
+template <class... T>
+struct is_tuple<std::tuple<T...>> : std::true_type {};
+
+template <class T>
+struct is_vector : std::false_type {};
+
+template <class T>
+struct is_vector<std::vector<T>> : std::true_type {};
+
+template <class X>
+std::tuple<X> as_tuple(X &&x) {
+    return std::tuple<X>(std::move(x));
+}
+
+template <class... X>
+std::tuple<X...> as_tuple(std::tuple<X...> &&x) {
+    return std::move(x);
+}
+
+static inline std::tuple<> as_tuple(std::nullptr_t) { return {}; }
+
+// the parts a vector<T> is appended from: T, [T] or nothing
+template <class X, class T>
+concept vector_part = std::same_as<X, T> || std::same_as<X, std::nullptr_t> ||
+                      std::same_as<decltype(large_of(std::declval<X>())), std::vector<T>>;
+
+template <class X>
+concept string_part = std::same_as<X, char> || std::same_as<X, std::nullptr_t> ||
+                      std::same_as<decltype(large_of(std::declval<X>())), std::string>;
+
+template <class X>
+size_t part_size(const X &x) {
+    if constexpr (std::same_as<X, std::nullptr_t>) {
+        return 0;
+    } else if constexpr (is_vector<X>::value || std::same_as<X, std::string> || small_container<X>) {
+        return x.size();
+    } else {
+        return 1;
+    }
+}
+
+template <class R, class X>
+void append_part(R &r, X &&x) {
+    if constexpr (std::same_as<X, std::nullptr_t>) {
+        (void)r, (void)x;
+    } else if constexpr (std::same_as<X, typename R::value_type>) {
+        r.push_back(std::move(x));
+    } else {
+        r.insert(r.end(), std::make_move_iterator(x.begin()), std::make_move_iterator(x.end()));
+    }
+}
+
+template <class X>
+X fold_merge(X &&x) {
+    return std::move(x);
+}
+
+template <class X, class Y, class... Z>
+merged_t<X, Y, Z...> fold_merge(X &&x, Y &&y, Z &&...z) {
+    return fold_merge(typed_merge(std::move(x), std::move(y)), std::move(z)...);
+}
+
+template <class... X>
+    requires(sizeof...(X) > 0 && (!std::is_lvalue_reference_v<X> && ...))
+merged_t<X...> typed_concat(X &&...x) {
+    using R = merged_t<X...>;
+    if constexpr (is_tuple<R>::value &&
+                  std::same_as<decltype(std::tuple_cat(as_tuple(std::declval<X>())...)), R>) {
+        return std::tuple_cat(as_tuple(std::move(x))...);
+    } else if constexpr (is_vector<R>::value) {
+        if constexpr ((vector_part<X, typename R::value_type> && ...)) {
+            R r;
+            r.reserve((part_size(x) + ...));
+            (append_part(r, std::move(x)), ...);
+            return r;
+        } else {
+            return fold_merge(std::move(x)...);
+        }
+    } else if constexpr (std::same_as<R, std::string> && (string_part<X> && ...)) {
+        R r;
+        r.reserve((part_size(x) + ...));
+        (append_part(r, std::move(x)), ...);
+        return r;
+    } else {
+        return fold_merge(std::move(x)...);
+    }
+}
+
+/** sequence of parsers
+ * operator* chains are flattened into one sequencer, so a*b*c*d runs as a single node.
+ * only a sequencer on the left is spliced: its parts already merge from the left, as a*b*c does,
+ * while a parenthesized right operand stays one part, so a*(b*c) merges a with the result of b*c.
+ * every part is kept until the last parser succeeds, then the result is built once by typed_concat.
+ */
+template <parsable... P>
+    requires(sizeof...(P) >= 2) &&
+            (std::same_as<left_of<P>, left_of<std::tuple_element_t<0, std::tuple<P...>>>> && ...) &&
+            (std::same_as<input_of<P>, input_of<std::tuple_element_t<0, std::tuple<P...>>>> && ...)
 class sequencer {
 public:
-    using right_t = decltype([]() {
-        right_of<PX> dx;
-        right_of<PY> dy;
-        return typed_merge(std::move(dx), std::move(dy));
-    }());
-    using left_t = left_of<PX>;
+    using input_t = input_of<std::tuple_element_t<0, std::tuple<P...>>>;
+    using right_t = merged_t<right_of<P>...>;
+    using left_t = left_of<std::tuple_element_t<0, std::tuple<P...>>>;
     using either_t = either<right_t, left_t>;
 
 private:
-    PX px;
-    PY py;
+    using parts_t = std::tuple<std::optional<right_of<P>>...>;
+    std::tuple<P...> parsers;
 
-public:
-    sequencer(const PX &_pr, const PY &_pl) : px(_pr), py(_pl) {}
-    sequencer(PX &&_pr, PY &&_pl) : px(_pr), py(_pl) {}
-
-    either_t operator()(std::istream &is) const {
-        // right
-        either_of<PX> r = px(is);
-        switch (r.get_mode()) {
+    template <size_t I>
+    bool parse(input_t &is, parts_t &parts, std::optional<left_t> &failure) const {
+        either_of<std::tuple_element_t<I, std::tuple<P...>>> e = std::get<I>(parsers)(is);
+        switch (e.get_mode()) {
         case either_mode::right:
-            break;
+            std::get<I>(parts).emplace(std::move(e.get_right()));
+            return true;
         case either_mode::left:
-            return r.into_left();
+            failure.emplace(std::move(e.get_left()));
+            return false;
         case either_mode::none:
             throw std::range_error("none is unexpceted");
         default:
             throw std::range_error("others is unexpceted");
         }
+    }
 
-        // left
-        either_of<PY> l = py(is);
-        switch (l.get_mode()) {
-        case either_mode::right:
-            break;
-        case either_mode::left:
-            return l.into_left();
-        case either_mode::none:
-            throw std::range_error("none is unexpceted");
-        default:
-            throw std::range_error("others is unexpceted");
+public:
+    sequencer(const P &..._parsers) : parsers(_parsers...) {}
+
+    either_t operator()(input_t &is) const {
+        parts_t parts;
+        std::optional<left_t> failure;
+        const bool success = [&]<size_t... I>(std::index_sequence<I...>) {
+            return (parse<I>(is, parts, failure) && ...);
+        }(std::index_sequence_for<P...>());
+        if (!success) {
+            return left(std::move(*failure));
         }
-
-        return right(typed_merge(std::move(r.get_right()), std::move(l.get_right())));
+        return right(std::apply([](auto &...part) { return typed_concat(std::move(*part)...); }, parts));
     }
+
+    const std::tuple<P...> &get_parsers() const { return parsers; }
+
+    // an empty match of the head exposes the rest, which first_of reports as every byte
+    firsts::first_set first() const { return firsts::first_of(std::get<0>(parsers)); }
 };
 
+template <class... P>
+sequencer(P...) -> sequencer<P...>;
+
 template <parsable PX, parsable PY>
-    requires std::same_as<left_of<PX>, left_of<PY>>
+    requires std::same_as<left_of<PX>, left_of<PY>> && std::same_as<input_of<PX>, input_of<PY>>
 auto operator*(const PX &r, const PY &l) {
     return sequencer<PX, PY>(r, l);
 }
 
+template <parsable... PX, parsable PY>
+auto operator*(const sequencer<PX...> &x, const PY &y) {
+    return std::apply([&y](const PX &...px) { return sequencer<PX..., PY>(px..., y); }, x.get_parsers());
+}
+
 template <parsable PX, parsable PY>
-    requires std::same_as<right_of<PX>, right_of<PY>>
+    requires std::same_as<right_of<PX>, right_of<PY>> && std::same_as<input_of<PX>, input_of<PY>>
 class branch {
 public:
+    using input_t = input_of<PX>;
     using right_t = right_of<PX>;
     using left_t = left_of<PY>;
     using either_t = either<right_t, left_t>;
@@ -191,18 +396,24 @@ public:
 private:
     PX px;
     PY py;
+    [[no_unique_address]] probes::probe probe{"branch"};
 
 public:
     branch(const PX &_px, const PY &_py) : px(_px), py(_py) {}
     branch(PX &&_px, PY &&_py) : px(_px), py(_py) {}
-    either_t operator()(std::istream &is) const {
-        const std::streampos pos = is.tellg();
+    either_t operator()(input_t &is) const {
+        probes::scope<probes::probe, input_t> call(probe, is);
+        const auto pos = inputs::tell(is);
         {
+            const cuts::cut_point<input_t, cuts::may_cut<PX>> point(is, pos);
             either_t e = px(is);
             switch (e.get_mode()) {
             case either_mode::right:
+                call.succeeded();
                 return e.into_right();
             case either_mode::left:
+                // committed by a cut, py is not tried
+                if (point.committed()) return e.into_left();
                 break;
             case either_mode::none:
                 throw std::range_error("none is not support");
@@ -210,11 +421,15 @@ public:
                 throw std::domain_error("mode domain error");
             }
         }
-        is.seekg(pos);
+        call.rewinding(pos);
+        inputs::rewind(is, pos);
         {
+            // a cut in py commits py, not the alternative enclosing this branch
+            const cuts::cut_point<input_t, cuts::may_cut<PY>> point(is, pos);
             either_t e = py(is);
             switch (e.get_mode()) {
             case either_mode::right:
+                call.succeeded();
                 return e.into_right();
             case either_mode::left:
                 return e.into_left();
@@ -225,12 +440,111 @@ public:
             }
         }
     }
+
+    firsts::first_set first() const { return firsts::first_of(px) | firsts::first_of(py); }
 };
 
 template <parsable PX, parsable PY>
-    requires std::same_as<right_of<PX>, right_of<PY>>
+    requires std::same_as<right_of<PX>, right_of<PY>> && std::same_as<input_of<PX>, input_of<PY>>
 branch<PX, PY> operator+(const PX &px, const PY &py) {
     return branch(px, py);
 }
 
+/** n-ary branch over characters
+ * alternatives are tried in order, but only those whose FIRST set holds the next byte.
+ * the candidates for each byte are computed once, so disjoint alternatives cost one table lookup.
+ */
+template <parsable... P>
+    requires(sizeof...(P) > 0) && (std::same_as<input_of<P>, std::istream> && ...)
+class choice {
+    using last_t = std::tuple_element_t<sizeof...(P) - 1, std::tuple<P...>>;
+
+public:
+    using right_t = right_of<std::tuple_element_t<0, std::tuple<P...>>>;
+    using left_t = left_of<last_t>;
+    using either_t = either<right_t, left_t>;
+
+private:
+    using candidates_t = std::bitset<sizeof...(P)>;
+    constexpr static size_t end_of_input = 256;
+
+    std::tuple<P...> parsers;
+    std::array<candidates_t, 257> candidates;
+
+    template <size_t I>
+    static either_t call(const choice &c, std::istream &is) {
+        return std::get<I>(c.parsers)(is);
+    }
+
+    template <size_t... I>
+    constexpr static auto make_calls(std::index_sequence<I...>) {
+        return std::array<either_t (*)(const choice &, std::istream &), sizeof...(P)>{&call<I>...};
+    }
+    constexpr static auto calls = make_calls(std::index_sequence_for<P...>());
+
+    template <size_t... I>
+    void build(std::index_sequence<I...>) {
+        const std::array<firsts::first_set, sizeof...(P)> sets = {firsts::first_of(std::get<I>(parsers))...};
+        for (size_t i = 0; i < sets.size(); i++) {
+            for (size_t c = 0; c < 256; c++) {
+                candidates[c].set(i, sets[i].test(c));
+            }
+            candidates[end_of_input].set(i);
+        }
+    }
+
+public:
+    choice(const P &..._parsers)
+        requires(std::same_as<right_of<P>, right_t> && ...) && (std::constructible_from<left_t, left_of<P>> && ...)
+        : parsers(_parsers...) {
+        build(std::index_sequence_for<P...>());
+    }
+
+    either_t operator()(std::istream &is) const {
+        const int c = is.peek();
+        const candidates_t &next = candidates[c == -1 ? end_of_input : c];
+
+        // no alternative can start here, the last one reports the failure
+        if (next.none()) {
+            if constexpr (cuts::may_cut<last_t>) {
+                const cuts::cut_point<std::istream> point(is, primitive::tell(is));
+                return std::get<sizeof...(P) - 1>(parsers)(is);
+            } else {
+                return std::get<sizeof...(P) - 1>(parsers)(is);
+            }
+        }
+
+        const std::streampos pos = primitive::tell(is);
+        const cuts::cut_point<std::istream, (cuts::may_cut<P> || ...)> point(is, pos);
+        for (size_t i = 0, rest = next.count(); i < sizeof...(P); i++) {
+            if (!next.test(i)) continue;
+
+            either_t e = calls[i](*this, is);
+            switch (e.get_mode()) {
+            case either_mode::right:
+                return e.into_right();
+            case either_mode::left:
+                if (--rest == 0 || point.committed()) return e.into_left();
+                break;
+            case either_mode::none:
+                throw std::range_error("none is not support");
+            default:
+                throw std::domain_error("mode domain error");
+            }
+            primitive::rewind(is, pos);
+        }
+        throw std::logic_error("choice has no candidate");
+    }
+
+    firsts::first_set first() const {
+        firsts::first_set chars;
+        for (size_t c = 0; c < 256; c++) {
+            chars.set(c, candidates[c].any());
+        }
+        return chars;
+    }
+
+    const candidates_t &get_candidates(int c) const { return candidates[c == -1 ? end_of_input : c]; }
+};
+
 } // namespace tokenizes::combinators
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "benches.hpp"
+#include "combinators.hpp"
+#include "mappers.hpp"
+#include "parsers.hpp"
+#include "primitive.hpp"
+#include "repeats.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace tokenizes::primitive;
+using tokenizes::benches::items;
+using tokenizes::benches::run_items;
+using tokenizes::combinators::operator*;
+using tokenizes::combinators::operator+;
+
+namespace combinators_bench {
+
+constexpr size_t corpus_size = 64 << 10;
+
+static std::string numbers() {
+    return items(corpus_size, [](std::mt19937 &random) { return std::to_string(random() % 1000000); });
+}
+
+static void branch_digit_or_alpha(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &random) {
+        const static std::string chars = "abcxyzABCXYZ0123456789";
+        return std::string(1, chars[random() % chars.size()]);
+    });
+    run_items(state, digit + alpha, text);
+}
+BENCHMARK(branch_digit_or_alpha);
+
+static void sequencer_signed_digits(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &random) {
+        return std::string(random() % 2 ? "+" : "-") + std::to_string(random() % 90 + 10);
+    });
+    run_items(state, sign * digit * digit, text);
+}
+BENCHMARK(sequencer_signed_digits);
+
+static void repeat_digits(benchmark::State &state) {
+    run_items(state, tokenizes::repeats::many1(digit), numbers());
+}
+BENCHMARK(repeat_digits);
+
+static void mapper_digits_to_int(benchmark::State &state) {
+    const auto parser =
+        tokenizes::mappers::mapper_right(tokenizes::repeats::many1(digit), [](const std::string &s) { return std::stoi(s); });
+    run_items(state, parser, numbers());
+}
+BENCHMARK(mapper_digits_to_int);
+
+// the same parser through shell's type erasure
+static void shell_digits_to_int(benchmark::State &state) {
+    const auto parser = tokenizes::shell(digit).many1().map_right([](const std::string &s) { return std::stoi(s); });
+    run_items(state, parser, numbers());
+}
+BENCHMARK(shell_digits_to_int);
+
+} // namespace combinators_bench
@@ -2,11 +2,14 @@
 #include "primitive.hpp"
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <memory>
 #include <sstream>
 using std::make_tuple;
 using std::stringstream;
 using tokenizes::primitive::digit;
+using tokenizes::primitive::dot;
 using tokenizes::primitive::sign;
+using tokenizes::primitive::tag;
 using namespace tokenizes::combinators;
 
 namespace tupled_merge_tests {
@@ -109,6 +112,35 @@ TEST(typed_merge, nullptr_both) {
     EXPECT_EQ(x, nullptr);
 }
 
+// variadic version
+
+TEST(typed_concat, tuple) {
+    auto x = typed_concat(1, 'a', nullptr, make_tuple(2, 'b'));
+    EXPECT_EQ(x, make_tuple(1, 'a', 2, 'b'));
+}
+
+TEST(typed_concat, vector) {
+    auto x = typed_concat(1, std::vector<int>{2, 3}, nullptr, 4);
+    EXPECT_EQ(x, std::vector<int>({1, 2, 3, 4}));
+}
+
+TEST(typed_concat, string) {
+    auto x = typed_concat('a', std::string("bc"), 'd', nullptr);
+    EXPECT_EQ(x, "abcd");
+}
+
+TEST(typed_concat, fold) {
+    // (1,2) folds into a vector before the tuple is spliced
+    auto x = typed_concat(1, 2, make_tuple('a'));
+    EXPECT_EQ(x, make_tuple(std::vector<int>{1, 2}, 'a'));
+}
+
+TEST(typed_concat, move_only) {
+    auto x = typed_concat(std::make_unique<int>(1), nullptr, std::make_unique<int>(2));
+    ASSERT_EQ(x.size(), 2);
+    EXPECT_EQ(*x[1], 2);
+}
+
 } // namespace tupled_merge_tests
 
 namespace sequencer2_tests {
@@ -162,6 +194,40 @@ TEST(sequencer, success) {
     EXPECT_EQ(parser(ss).opt_right(), "000");
 }
 
+
+TEST(sequencer, flatten) {
+    static_assert(std::tuple_size_v<std::remove_cvref_t<decltype(parser.get_parsers())>> == 3);
+    const auto nested = (digit * digit) * (digit * digit);
+    static_assert(std::tuple_size_v<std::remove_cvref_t<decltype(nested.get_parsers())>> == 3);
+    stringstream ss;
+    ss << "0123";
+    EXPECT_EQ(nested(ss).opt_right(), "0123");
+}
+
+TEST(sequencer, tuple) {
+    const tokenizes::primitive::digit_parser number(10);
+    const auto tuple = sequencer(number, sign, number * number);
+    stringstream ss;
+    ss << "1+23";
+    EXPECT_EQ(tuple(ss).opt_right(), make_tuple(1, '+', std::vector<int>{2, 3}));
+}
+
+TEST(sequencer, grouping) {
+    const tokenizes::primitive::digit_parser i(10);
+    const auto c = digit;
+    // a grouped right operand merges as a whole, as it did before chains were flattened
+    static_assert(std::same_as<decltype(i * (i * c))::right_t, std::tuple<int, int, char>>);
+    static_assert(std::same_as<decltype(c * (c * i))::right_t, std::tuple<char, char, int>>);
+    static_assert(std::same_as<decltype(i * (c * c))::right_t, std::tuple<int, std::string>>);
+    // a left operand merges part by part
+    static_assert(std::same_as<decltype((i * i) * c)::right_t, std::tuple<std::vector<int>, char>>);
+    static_assert(std::same_as<decltype(i * i * c)::right_t, decltype((i * i) * c)::right_t>);
+
+    stringstream ss;
+    ss << "123";
+    EXPECT_EQ((i * (i * c))(ss).opt_right(), make_tuple(1, 2, '3'));
+}
+
 } // namespace sequencer3_tests
 
 namespace branch_tests {
@@ -185,3 +251,49 @@ TEST(branch, others) {
     EXPECT_EQ(parser(ss).opt_right(),std::nullopt);
 }
 } // namespace branch_tests
+
+namespace choice_tests {
+const static auto parser = choice(tag("if"), tag("in"), tag("else"), tag("x"));
+
+TEST(choice, first) {
+    stringstream ss;
+    ss << "else";
+    EXPECT_EQ(parser(ss).opt_right(), "else");
+}
+
+TEST(choice, overlap) {
+    stringstream ss;
+    ss << "in";
+    EXPECT_EQ(parser(ss).opt_right(), "in");
+}
+
+TEST(choice, others) {
+    stringstream ss;
+    ss << "y";
+    EXPECT_TRUE(parser(ss).is_left());
+    EXPECT_EQ(ss.tellg(), 0);
+}
+
+TEST(choice, end_of_input) {
+    stringstream ss;
+    EXPECT_TRUE(parser(ss).is_left());
+}
+
+TEST(choice, candidates) {
+    EXPECT_EQ(parser.get_candidates('i').to_ulong(), 0b0011);
+    EXPECT_EQ(parser.get_candidates('e').to_ulong(), 0b0100);
+    EXPECT_EQ(parser.get_candidates('y').to_ulong(), 0);
+    EXPECT_EQ(parser.get_candidates(-1).to_ulong(), 0b1111);
+}
+
+TEST(choice, atoms) {
+    const auto atoms = choice(sign, digit, dot);
+    stringstream ss;
+    ss << "-1.";
+    EXPECT_EQ(atoms(ss).opt_right(), '-');
+    EXPECT_EQ(atoms(ss).opt_right(), '1');
+    EXPECT_EQ(atoms(ss).opt_right(), '.');
+    EXPECT_EQ(atoms.first(), (sign + digit + dot).get_chars());
+}
+
+} // namespace choice_tests
@@ -3,21 +3,38 @@
 #include <concepts>
 #include <istream>
 #include <tuple>
+#include <type_traits>
 namespace tokenizes::concepts {
+
+// input a parser consumes: std::istream unless the parser declares input_t
+template <class P>
+struct input_traits {
+    using type = std::istream;
+};
+
+template <class P>
+    requires requires { typename P::input_t; }
+struct input_traits<P> {
+    using type = typename P::input_t;
+};
+
+template <class P>
+using input_of = typename input_traits<std::remove_cvref_t<P>>::type;
+
 template <typename P>
-concept parsable = std::invocable<P, std::istream &> &&
-                   (std::move_constructible<P> || std::copy_constructible<P>)&&requires(const P &p, std::istream &is) {
+concept parsable = std::invocable<P, input_of<P> &> &&
+                   (std::move_constructible<P> || std::copy_constructible<P>)&&requires(const P &p, input_of<P> &is) {
                        typename decltype(p(is))::right_t;
                        typename decltype(p(is))::left_t;
                    };
 
 template <parsable P>
-using either_of = typename std::invoke_result_t<P, std::istream &>;
+using either_of = typename std::invoke_result_t<P, input_of<P> &>;
 
 template <parsable P>
-using right_of = typename std::invoke_result_t<P, std::istream &>::right_t;
+using right_of = typename std::invoke_result_t<P, input_of<P> &>::right_t;
 template <parsable P>
-using left_of = typename std::invoke_result_t<P, std::istream &>::left_t;
+using left_of = typename std::invoke_result_t<P, input_of<P> &>::left_t;
 
 template <class C, class I>
 concept has_push_back = requires(C &c, const I &item) { c.push_back(item); };
@@ -0,0 +1,21 @@
+#include "contexts.hpp"
+namespace tokenizes::contexts {
+
+static int resource_index() {
+    static const int index = std::ios_base::xalloc();
+    return index;
+}
+
+std::pmr::memory_resource *resource_of(std::istream &is) {
+    void *p = is.pword(resource_index());
+    return p ? static_cast<std::pmr::memory_resource *>(p) : std::pmr::get_default_resource();
+}
+
+std::pmr::memory_resource *attach(std::istream &is, std::pmr::memory_resource *resource) {
+    void *&p = is.pword(resource_index());
+    auto *previous = static_cast<std::pmr::memory_resource *>(p);
+    p = resource;
+    return previous;
+}
+
+} // namespace tokenizes::contexts
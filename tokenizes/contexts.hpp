@@ -0,0 +1,60 @@
+#pragma once
+#include <concepts>
+#include <istream>
+#include <memory_resource>
+#include <type_traits>
+namespace tokenizes::contexts {
+
+/** parse context: the memory resource results are allocated from
+ * it is attached to a std::istream through pword, so every combinator reading that stream sees it.
+ * the pmr variants of the result-allocating parsers take every result from it: pmr_tag, pmr_tag_list,
+ * pmr_string_parser, pmr_recognition and the pmr_many0/pmr_many1 repeats, so a monotonic arena attached here
+ * covers a whole document's parse. the plain parsers keep their std::string and std::vector results.
+ */
+std::pmr::memory_resource *resource_of(std::istream &is);
+
+// other inputs carry no context
+template <class I>
+    requires(!std::derived_from<I, std::istream>)
+std::pmr::memory_resource *resource_of(I &) {
+    return std::pmr::get_default_resource();
+}
+
+// attaches a resource (nullptr detaches), returning the previous one
+std::pmr::memory_resource *attach(std::istream &is, std::pmr::memory_resource *resource);
+
+// attaches a resource for the lifetime of the scope
+class resource_scope {
+    std::istream &is;
+    std::pmr::memory_resource *previous;
+
+public:
+    resource_scope(std::istream &_is, std::pmr::memory_resource *resource) : is(_is), previous(attach(is, resource)) {}
+    resource_scope(const resource_scope &) = delete;
+    ~resource_scope() { attach(is, previous); }
+};
+
+template <class C>
+concept pmr_aware = std::uses_allocator_v<C, std::pmr::polymorphic_allocator<>>;
+
+// empty result container, allocating from the input's resource when it can
+template <class C, class I>
+C make_result(I &is) {
+    if constexpr (pmr_aware<C>) {
+        return C(resource_of(is));
+    } else {
+        return C();
+    }
+}
+
+// copy of a result, moved onto the input's resource when it can
+template <class C, class I>
+C copy_result(const C &c, I &is) {
+    if constexpr (pmr_aware<C>) {
+        return C(c, resource_of(is));
+    } else {
+        return C(c);
+    }
+}
+
+} // namespace tokenizes::contexts
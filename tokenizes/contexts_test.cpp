@@ -0,0 +1,156 @@
+#include "allocs.hpp"
+#include "contexts.hpp"
+#include "mappers.hpp"
+#include "primitive.hpp"
+#include "repeats.hpp"
+#include "tokens.hpp"
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <variant>
+using namespace tokenizes::contexts;
+using tokenizes::primitive::digit;
+
+namespace contexts_tests {
+
+// counts what reaches the upstream resource
+class counting_resource : public std::pmr::memory_resource {
+    std::pmr::memory_resource *upstream = std::pmr::new_delete_resource();
+
+    void *do_allocate(size_t bytes, size_t align) override {
+        allocations++;
+        return upstream->allocate(bytes, align);
+    }
+    void do_deallocate(void *p, size_t bytes, size_t align) override { upstream->deallocate(p, bytes, align); }
+    bool do_is_equal(const memory_resource &x) const noexcept override { return this == &x; }
+
+public:
+    size_t allocations{0};
+};
+
+TEST(context, default) {
+    std::stringstream ss;
+    EXPECT_EQ(resource_of(ss), std::pmr::get_default_resource());
+}
+
+TEST(context, scope) {
+    std::pmr::monotonic_buffer_resource arena;
+    std::stringstream ss;
+    {
+        resource_scope scope(ss, &arena);
+        EXPECT_EQ(resource_of(ss), &arena);
+    }
+    EXPECT_EQ(resource_of(ss), std::pmr::get_default_resource());
+}
+
+TEST(context, repeat) {
+    counting_resource counter;
+    std::pmr::monotonic_buffer_resource arena(&counter);
+    std::stringstream ss;
+    ss << std::string(1000, '7');
+    resource_scope scope(ss, &arena);
+
+    const auto e = tokenizes::repeats::pmr_many1(digit)(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().size(), 1000);
+    EXPECT_EQ(e.get_right().get_allocator().resource(), &arena);
+    EXPECT_GT(counter.allocations, 0);
+}
+
+TEST(context, fold) {
+    std::pmr::monotonic_buffer_resource arena;
+    std::stringstream ss;
+    ss << "123";
+    resource_scope scope(ss, &arena);
+
+    const auto collect = tokenizes::repeats::fold(digit, std::pmr::string(), [](std::pmr::string acc, char c) {
+        acc.push_back(c);
+        return acc;
+    });
+    const auto e = collect(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right(), "123");
+    EXPECT_EQ(e.get_right().get_allocator().resource(), &arena);
+}
+
+TEST(context, tokenize) {
+    std::pmr::monotonic_buffer_resource arena;
+    std::stringstream ss;
+    ss << "x = 1 + 2";
+    const auto e = tokenizes::tokens::token_parser().tokenize(ss, &arena);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().size(), 5);
+    EXPECT_EQ(e.get_right().get_allocator().resource(), &arena);
+}
+
+TEST(context, token_values) {
+    using tokenizes::tokens::text_t;
+    std::pmr::monotonic_buffer_resource arena;
+    const std::string text = "x = 'a text literal longer than the inline buffer'";
+    std::stringstream ss(text);
+    const tokenizes::tokens::token_parser parser;
+    tokenizes::tokens::token_context context;
+    for (const auto &e : {parser.tokenize(ss, &arena), parser.tokenize(text, context, &arena)}) {
+        ASSERT_TRUE(e.is_right());
+        ASSERT_EQ(e.get_right().size(), 3);
+        const text_t &value = std::get<text_t>(e.get_right()[2].value);
+        EXPECT_EQ(value, "a text literal longer than the inline buffer");
+        EXPECT_EQ(value.get_allocator().resource(), &arena);
+    }
+}
+
+TEST(context, copies_keep_the_arena) {
+    using tokenizes::tokens::text_t;
+    std::pmr::monotonic_buffer_resource arena;
+    std::stringstream ss("'a text literal longer than the inline buffer'");
+    const auto e = tokenizes::tokens::token_parser().tokenize(ss, &arena);
+    ASSERT_TRUE(e.is_right());
+
+    const auto copy = e;
+    ASSERT_TRUE(copy.is_right());
+    EXPECT_EQ(copy.get_right().get_allocator().resource(), &arena);
+    EXPECT_EQ(std::get<text_t>(copy.get_right()[0].value).get_allocator().resource(), &arena);
+    EXPECT_EQ(e.opt_right()->get_allocator().resource(), &arena);
+}
+
+TEST(context, primitive_results) {
+    counting_resource counter;
+    std::pmr::monotonic_buffer_resource arena(&counter);
+    std::stringstream ss("if'a text literal longer than the inline buffer'while 123+");
+    resource_scope scope(ss, &arena);
+
+    const auto keyword = tokenizes::primitive::pmr_tag("if")(ss);
+    ASSERT_TRUE(keyword.is_right());
+    EXPECT_EQ(keyword.get_right().get_allocator().resource(), &arena);
+    const auto body = tokenizes::primitive::pmr_string_parser()(ss);
+    ASSERT_TRUE(body.is_right());
+    EXPECT_EQ(body.get_right(), "a text literal longer than the inline buffer");
+    EXPECT_EQ(body.get_right().get_allocator().resource(), &arena);
+    const auto loop = tokenizes::primitive::pmr_tag_list({"if", "while", "whilst"})(ss);
+    ASSERT_TRUE(loop.is_right());
+    EXPECT_EQ(loop.get_right(), "while");
+    EXPECT_EQ(loop.get_right().get_allocator().resource(), &arena);
+    ss.ignore();
+    const auto number = tokenizes::mappers::pmr_recognition(tokenizes::repeats::many1(digit))(ss);
+    ASSERT_TRUE(number.is_right());
+    EXPECT_EQ(number.get_right(), "123");
+    EXPECT_EQ(number.get_right().get_allocator().resource(), &arena);
+    EXPECT_GT(counter.allocations, 0);
+}
+
+TEST(context, parse_off_the_heap) {
+    alignas(std::max_align_t) char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    std::stringstream ss("'a text literal longer than the inline buffer'");
+    resource_scope scope(ss, &arena);
+    const tokenizes::primitive::pmr_string_parser parser;
+
+    const tokenizes::allocs::counting_scope counting;
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(counting.counts().allocations, 0);
+}
+
+} // namespace contexts_tests
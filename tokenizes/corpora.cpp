@@ -0,0 +1,227 @@
+#include "corpora.hpp"
+#include "primitive.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <charconv>
+namespace tokenizes::corpora {
+
+using tokenizes::tokens::token_id;
+
+std::optional<token_mix> mix_of(std::string_view name) {
+    if (name == "balanced") return token_mix{};
+    if (name == "numeric") return token_mix{2, 6, 4, 0, 1, 0};
+    if (name == "textual") return token_mix{1, 0, 0, 6, 2, 0};
+    if (name == "marks") return token_mix{8, 1, 0, 0, 1, 0};
+    return std::nullopt;
+}
+
+corpus_generator::corpus_generator(const corpus_options &_options) : options(_options), state(_options.seed) {
+    for (uint32_t id = tokens::token_id_marks;; id++) {
+        const std::string_view m = tokens::mark_of(static_cast<token_id>(id));
+        if (m.empty()) break;
+        marks.push_back(m);
+    }
+    for (int c = 1; c < 128; c++) {
+        if (primitive::escape_of(static_cast<char>(c))) {
+            escapes.push_back(static_cast<char>(c));
+        }
+    }
+}
+
+uint64_t corpus_generator::next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+void corpus_generator::mark(std::string &out) { out += marks[below(marks.size())]; }
+
+void corpus_generator::integer(std::string &out) {
+    constexpr static struct {
+        const char *prefix;
+        int base;
+    } bases[]{{"", 10}, {"", 10}, {"0b", 2}, {"0q", 4}, {"0o", 8}, {"0d", 10}, {"0x", 16}};
+    const auto &[prefix, base] = bases[below(std::size(bases))];
+
+    if (below(8) == 0 && !operand) out += '-';
+    out += prefix;
+    // small values are the common case, but every magnitude up to INT_MAX shows up
+    const uint64_t value = below(uint64_t(1) << (below(31) + 1));
+    char digits[40];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value, base);
+    out.append(digits, result.ptr);
+}
+
+void corpus_generator::real(std::string &out) {
+    if (below(8) == 0 && !operand) out += '-';
+    out += std::to_string(below(1000000));
+    out += '.';
+    out += std::to_string(below(1000000));
+    if (below(4) == 0) {
+        out += below(2) ? "e+" : "e-";
+        out += std::to_string(below(20));
+    }
+}
+
+void corpus_generator::text(std::string &out) {
+    const char quote = below(2) ? '\'' : '"';
+    out += quote;
+    for (size_t n = below(options.max_text + 1); n > 0; n--) {
+        if (below(8) == 0) {
+            out += '\\';
+            out += escapes[below(escapes.size())];
+            continue;
+        }
+        // printable, but not a quote or a backslash
+        char c;
+        do {
+            c = static_cast<char>(' ' + below(95));
+        } while (c == quote || c == '\\');
+        out += c;
+    }
+    out += quote;
+}
+
+void corpus_generator::identifier(std::string &out) {
+    constexpr static std::string_view head = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+    constexpr static std::string_view tail = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+    const size_t begin = out.size();
+    do {
+        out.resize(begin);
+        out += head[below(head.size())];
+        for (size_t n = below(options.max_identifier); n > 0; n--) {
+            out += tail[below(tail.size())];
+        }
+    } while (std::string_view(out).substr(begin) == "true" || std::string_view(out).substr(begin) == "false");
+}
+
+void corpus_generator::token(std::string &out) {
+    const token_mix &m = options.mix;
+    const uint32_t weights[]{m.marks, m.integers, m.reals, m.texts, m.identifiers, m.booleans};
+    uint64_t total = 0;
+    for (const uint32_t w : weights) total += w;
+    if (total == 0) return;
+
+    uint64_t r = below(total);
+    size_t kind = 0;
+    while (r >= weights[kind]) r -= weights[kind++];
+    const size_t begin = out.size();
+    switch (kind) {
+    case 0:
+        mark(out);
+        break;
+    case 1:
+        integer(out);
+        break;
+    case 2:
+        real(out);
+        break;
+    case 3:
+        text(out);
+        break;
+    case 4:
+        identifier(out);
+        break;
+    default:
+        out += below(2) ? "true" : "false";
+        break;
+    }
+    operand = kind != 0 || out.compare(begin, std::string::npos, ")") == 0;
+    out += below(16) ? ' ' : '\n';
+    count++;
+}
+
+void corpus_generator::append(std::string &out, size_t bytes) {
+    const size_t end = out.size() + bytes;
+    out.reserve(end + 64);
+    while (out.size() < end) {
+        const size_t size = out.size();
+        token(out);
+        if (out.size() == size) break; // empty mix
+    }
+}
+
+std::string corpus_generator::generate(size_t bytes) {
+    std::string out;
+    append(out, bytes);
+    return out;
+}
+
+void corpus_generator::write(std::ostream &os, uint64_t bytes, size_t block) {
+    std::string buffer;
+    for (uint64_t written = 0; written < bytes;) {
+        buffer.clear();
+        append(buffer, static_cast<size_t>(std::min<uint64_t>(block, bytes - written)));
+        if (buffer.empty()) break;
+        os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        written += buffer.size();
+    }
+}
+
+corpus_streambuf::corpus_streambuf(const corpus_options &options, uint64_t bytes, size_t _block)
+    : generator(options), remaining(bytes), block(std::max<size_t>(_block, 1)) {
+    setg(window.data(), window.data(), window.data());
+}
+
+corpus_streambuf::int_type corpus_streambuf::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    if (remaining == 0) return traits_type::eof();
+
+    // the current block becomes the previous one
+    const size_t current = window.size() - previous;
+    window.erase(0, previous);
+    base += previous;
+    previous = current;
+    const size_t before = window.size();
+    generator.append(window, static_cast<size_t>(std::min<uint64_t>(block, remaining)));
+    const size_t grown = window.size() - before;
+    remaining -= std::min<uint64_t>(grown, remaining);
+    if (grown == 0) remaining = 0; // empty mix
+
+    setg(window.data(), window.data() + previous, window.data() + window.size());
+    return gptr() < egptr() ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+}
+
+corpus_streambuf::pos_type corpus_streambuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                     std::ios_base::openmode which) {
+    switch (dir) {
+    case std::ios_base::beg:
+        return seekpos(off, which);
+    case std::ios_base::cur:
+        return seekpos(static_cast<off_type>(base) + (gptr() - eback()) + off, which);
+    default:
+        return pos_type(off_type(-1)); // the end is not generated yet
+    }
+}
+
+corpus_streambuf::pos_type corpus_streambuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+    const off_type off = static_cast<off_type>(pos) - static_cast<off_type>(base);
+    if (!(which & std::ios_base::in) || off < 0 || off > egptr() - eback()) {
+        return pos_type(off_type(-1));
+    }
+    setg(eback(), eback() + off, egptr());
+    return pos;
+}
+
+std::optional<uint64_t> size_of(std::string_view text) {
+    uint64_t value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end == text.data()) return std::nullopt;
+
+    const std::string_view unit(end, text.data() + text.size() - end);
+    int shift = 0;
+    if (unit == "K" || unit == "KB") {
+        shift = 10;
+    } else if (unit == "M" || unit == "MB") {
+        shift = 20;
+    } else if (unit == "G" || unit == "GB") {
+        shift = 30;
+    } else if (!unit.empty()) {
+        return std::nullopt;
+    }
+    if (value > (UINT64_MAX >> shift)) return std::nullopt;
+    return value << shift;
+}
+
+} // namespace tokenizes::corpora
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace tokenizes::corpora {
+
+// relative frequencies of the token kinds
+struct token_mix {
+    uint32_t marks{4}, integers{2}, reals{1}, texts{1}, identifiers{3}, booleans{1};
+};
+
+// balanced, numeric, textual or marks
+std::optional<token_mix> mix_of(std::string_view name);
+
+struct corpus_options {
+    uint64_t seed{0};
+    token_mix mix{};
+    size_t max_text{24};       // characters in a string literal
+    size_t max_identifier{12}; // characters in an identifier
+};
+
+/** deterministic source text for the token language
+ * the same options give the same bytes on every platform: the generator is splitmix64,
+ * and values are drawn by plain modulo rather than through <random> distributions.
+ * marks come from mark_records, integers use every base prefix, strings use every escape.
+ * numbers are negative only where the lexer folds the sign, so every token lexes as it was generated.
+ */
+class corpus_generator {
+    corpus_options options;
+    uint64_t state;
+    uint64_t count{0};
+    bool operand{false}; // the last token ends an operand, so a sign would lex as a mark
+    std::vector<std::string_view> marks;
+    std::string escapes;
+
+    uint64_t next();
+    uint64_t below(uint64_t n) { return next() % n; }
+    void mark(std::string &out);
+    void integer(std::string &out);
+    void real(std::string &out);
+    void text(std::string &out);
+    void identifier(std::string &out);
+
+public:
+    corpus_generator(const corpus_options &_options = {});
+
+    // appends one token followed by a separator
+    void token(std::string &out);
+    // appends tokens until out grew by at least bytes
+    void append(std::string &out, size_t bytes);
+    std::string generate(size_t bytes);
+    // streams at least bytes, one block at a time, for corpora larger than memory
+    void write(std::ostream &os, uint64_t bytes, size_t block = size_t(1) << 20);
+
+    // tokens generated so far
+    uint64_t tokens() const { return count; }
+};
+
+/** the text of a corpus_generator as a read-only stream, generated one block at a time
+ * only the current and the previous block are resident, whatever the size; positions are offsets in the corpus,
+ * and seeking back reaches into the previous block, further than any lexer rewinds.
+ * the bytes are those of generate(bytes) with the same options.
+ */
+class corpus_streambuf : public std::streambuf {
+    corpus_generator generator;
+    uint64_t remaining;
+    size_t block;
+    std::string window; // previous and current block
+    uint64_t base{0};   // corpus offset of window[0]
+    size_t previous{0}; // bytes of the previous block in window
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+public:
+    corpus_streambuf(const corpus_options &options, uint64_t bytes, size_t _block = size_t(1) << 20);
+};
+
+// "64K", "10M", "1G" (binary units) or a plain number of bytes
+std::optional<uint64_t> size_of(std::string_view text);
+
+} // namespace tokenizes::corpora
@@ -0,0 +1,33 @@
+// writes a synthetic corpus (see corpora.hpp) to stdout
+//   tokenize_corpus [--size 1G] [--mix balanced|numeric|textual|marks] [--seed n] > corpus.txt
+#include "corpora.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
+int main(int argc, char **argv) {
+    using namespace tokenizes::corpora;
+    uint64_t bytes = uint64_t(1) << 20;
+    corpus_options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string_view arg = argv[i], value = argv[i + 1];
+        if (arg == "--size" && size_of(value)) {
+            bytes = *size_of(value);
+        } else if (arg == "--mix" && mix_of(value)) {
+            options.mix = *mix_of(value);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--size 1G] [--mix balanced|numeric|textual|marks] [--seed n]\n";
+            return 2;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cerr << "usage: " << argv[0] << " [--size 1G] [--mix balanced|numeric|textual|marks] [--seed n]\n";
+        return 2;
+    }
+
+    std::ios::sync_with_stdio(false);
+    corpus_generator(options).write(std::cout, bytes);
+    return std::cout ? 0 : 1;
+}
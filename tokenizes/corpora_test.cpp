@@ -0,0 +1,118 @@
+#include "corpora.hpp"
+#include "lazies.hpp"
+#include "tokens.hpp"
+
+#include "gtest/gtest.h"
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+
+using namespace tokenizes::corpora;
+using tokenizes::tokens::span_lexer;
+using tokenizes::tokens::token_id;
+using tokenizes::tokens::token_parser;
+
+namespace corpora_tests {
+
+TEST(corpus_generator, is_deterministic) {
+    EXPECT_EQ(corpus_generator({.seed = 7}).generate(4096), corpus_generator({.seed = 7}).generate(4096));
+    EXPECT_NE(corpus_generator({.seed = 7}).generate(4096), corpus_generator({.seed = 8}).generate(4096));
+}
+
+TEST(corpus_generator, grows_by_prefix) {
+    const std::string a = corpus_generator({.seed = 1}).generate(1 << 12);
+    const std::string b = corpus_generator({.seed = 1}).generate(1 << 14);
+    EXPECT_TRUE(b.starts_with(a));
+}
+
+TEST(corpus_generator, covers_every_kind) {
+    corpus_generator generator({.seed = 3});
+    const std::string text = generator.generate(1 << 16);
+    EXPECT_GE(text.size(), 1u << 16);
+
+    const auto tokens = span_lexer().tokenize(text);
+    ASSERT_TRUE(tokens.is_right()) << tokens.get_left();
+    EXPECT_EQ(tokens.get_right().size(), generator.tokens());
+
+    std::set<token_id> ids;
+    for (const auto &t : tokens.get_right().get_tokens()) {
+        ids.insert(t.id);
+    }
+    for (const token_id id : {token_id::variable, token_id::boolean, token_id::integer, token_id::real,
+                              token_id::text, token_id::assign, token_id::rparen}) {
+        EXPECT_TRUE(ids.count(id)) << id;
+    }
+    for (const char *prefix : {" 0b", " 0q", " 0o", " 0d", " 0x", "\\n", "\\'"}) {
+        EXPECT_NE(text.find(prefix), std::string::npos) << prefix;
+    }
+}
+
+TEST(corpus_generator, every_engine_agrees) {
+    for (const char *mix : {"balanced", "numeric", "textual", "marks"}) {
+        const std::string text = corpus_generator({.seed = 5, .mix = *mix_of(mix)}).generate(1 << 14);
+        const token_parser parser;
+        std::istringstream ss(text);
+        const auto streamed = parser.tokenize(ss);
+        const auto spanned = parser.tokenize(text);
+        ASSERT_TRUE(streamed.is_right()) << mix << ": " << streamed.get_left();
+        ASSERT_TRUE(spanned.is_right()) << mix << ": " << spanned.get_left();
+        EXPECT_EQ(streamed.get_right().size(), spanned.get_right().size()) << mix;
+    }
+}
+
+TEST(corpus_generator, mix_shapes_the_text) {
+    const token_mix only_marks{1, 0, 0, 0, 0, 0};
+    const std::string text = corpus_generator({.mix = only_marks}).generate(1024);
+    EXPECT_EQ(text.find_first_not_of("=+-*/%() \n"), std::string::npos);
+
+    EXPECT_TRUE(corpus_generator({.mix = token_mix{0, 0, 0, 0, 0, 0}}).generate(1024).empty());
+}
+
+TEST(corpus_generator, streams_in_blocks) {
+    std::ostringstream os;
+    corpus_generator({.seed = 2}).write(os, 10000, 1000);
+    EXPECT_GE(os.str().size(), 10000u);
+    EXPECT_EQ(os.str().substr(0, 900), corpus_generator({.seed = 2}).generate(900).substr(0, 900));
+}
+
+TEST(corpus_streambuf, matches_generate) {
+    const std::string text = corpus_generator({.seed = 5}).generate(1 << 16);
+    corpus_streambuf buffer({.seed = 5}, 1 << 16, 1000);
+    std::istream is(&buffer);
+    EXPECT_EQ(std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()), text);
+    EXPECT_EQ(buffer.pubseekoff(0, std::ios::cur, std::ios::in), std::streampos(text.size()));
+}
+
+TEST(corpus_streambuf, seeks_into_the_previous_block) {
+    corpus_streambuf buffer({.seed = 5}, 1 << 16, 1000);
+    std::istream is(&buffer);
+    is.ignore(1500);
+    EXPECT_EQ(is.tellg(), std::streampos(1500));
+    const std::string text = corpus_generator({.seed = 5}).generate(1 << 16);
+    is.seekg(900);
+    EXPECT_EQ(is.get(), text[900]);
+    is.seekg(2500);
+    EXPECT_TRUE(is.fail()); // not generated yet
+}
+
+TEST(corpus_streambuf, lexes_like_the_text) {
+    corpus_generator generator({.seed = 2});
+    const std::string text = generator.generate(1 << 16);
+    corpus_streambuf buffer({.seed = 2}, 1 << 16, 512);
+    std::istream is(&buffer);
+    const auto tokens = token_parser().tokenize(is);
+    ASSERT_TRUE(tokens.is_right()) << tokens.get_left();
+    EXPECT_EQ(tokens.get_right().size(), generator.tokens());
+    EXPECT_EQ(tokens.get_right().back().pos.end, token_parser().tokenize(text).get_right().back().pos.end);
+}
+
+TEST(size_of, units) {
+    EXPECT_EQ(size_of("1024"), 1024u);
+    EXPECT_EQ(size_of("64K"), 64u << 10);
+    EXPECT_EQ(size_of("10GB"), uint64_t(10) << 30);
+    EXPECT_FALSE(size_of("10X"));
+    EXPECT_FALSE(size_of("M"));
+}
+
+} // namespace corpora_tests
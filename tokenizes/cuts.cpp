@@ -0,0 +1,101 @@
+#include "cuts.hpp"
+#include "primitive.hpp"
+#include <algorithm>
+namespace tokenizes::cuts {
+
+static int state_index() {
+    static const int index = std::ios_base::xalloc();
+    return index;
+}
+
+static void state_event(std::ios_base::event event, std::ios_base &ios, int index) {
+    void *&p = ios.pword(index);
+    switch (event) {
+    case std::ios_base::erase_event:
+        delete static_cast<cut_state *>(p);
+        p = nullptr;
+        break;
+    case std::ios_base::copyfmt_event:
+        // copyfmt shares the pointer, the copy gets its own frames
+        p = p ? new cut_state() : nullptr;
+        break;
+    default:
+        break;
+    }
+}
+
+cut_state &state_of(std::istream &is) {
+    void *&p = is.pword(state_index());
+    if (!p) {
+        p = new cut_state();
+        is.register_callback(state_event, state_index());
+    }
+    return *static_cast<cut_state *>(p);
+}
+
+void commit(std::istream &is) {
+    cut_state &state = state_of(is);
+    if (!state.frames.empty()) {
+        state.frames.back().live = false;
+    }
+
+    auto *buf = dynamic_cast<releasing_streambuf *>(is.rdbuf());
+    if (!buf) return;
+
+    const auto live = std::find_if(state.frames.begin(), state.frames.end(), [](const cut_frame &f) { return f.live; });
+    buf->release(live != state.frames.end() ? live->pos : static_cast<std::streamoff>(primitive::tell(is)));
+}
+
+bool releasing_streambuf::fill() {
+    if (end) return false;
+
+    const size_t offset = gptr() - eback(), size = window.size();
+    window.resize(size + block);
+    const size_t n = static_cast<size_t>(source->sgetn(window.data() + size, static_cast<std::streamsize>(block)));
+    window.resize(size + n);
+    end = n < block;
+    setg(window.data(), window.data() + offset, window.data() + window.size());
+    return n > 0;
+}
+
+releasing_streambuf::int_type releasing_streambuf::underflow() {
+    if (gptr() == egptr() && !fill()) {
+        return traits_type::eof();
+    }
+    return traits_type::to_int_type(*gptr());
+}
+
+releasing_streambuf::pos_type releasing_streambuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                           std::ios_base::openmode which) {
+    const std::streamoff current = base + (gptr() - eback());
+    switch (dir) {
+    case std::ios_base::beg:
+        return seekpos(off, which);
+    case std::ios_base::cur:
+        return seekpos(current + off, which);
+    default:
+        return pos_type(off_type(-1));
+    }
+}
+
+releasing_streambuf::pos_type releasing_streambuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+    const std::streamoff target = pos;
+    if (!(which & std::ios_base::in) || target < base) {
+        return pos_type(off_type(-1));
+    }
+    while (static_cast<size_t>(target - base) > window.size()) {
+        if (!fill()) return pos_type(off_type(-1));
+    }
+    setg(window.data(), window.data() + (target - base), window.data() + window.size());
+    return pos;
+}
+
+void releasing_streambuf::release(std::streamoff pos) {
+    const size_t offset = gptr() - eback();
+    const size_t n = static_cast<size_t>(std::clamp<std::streamoff>(pos - base, 0, offset));
+    window.erase(window.begin(), window.begin() + n);
+    base += n;
+    setg(window.data(), window.data() + (offset - n), window.data() + window.size());
+}
+
+} // namespace tokenizes::cuts
@@ -0,0 +1,130 @@
+#pragma once
+#include "either.hpp"
+#include "firsts.hpp"
+#include <concepts>
+#include <cstddef>
+#include <istream>
+#include <streambuf>
+#include <type_traits>
+#include <vector>
+namespace tokenizes::cuts {
+
+using tokenizes::eithers::either;
+
+/** rollback point held by branch, choice or a repeat item
+ * a cut kills the innermost live point: that alternative is committed and its failure is final.
+ */
+struct cut_frame {
+    std::streamoff pos;
+    bool live;
+};
+
+// rollback points of one stream, attached through pword
+struct cut_state {
+    std::vector<cut_frame> frames;
+};
+
+cut_state &state_of(std::istream &is);
+
+/** whether a parser may run a cut, known at compile time
+ * cut declares it with a static member cuts, and a class template may cut when any of its type arguments may,
+ * so sequencer, branch, repeat, the mappers and the like pass it up without declaring anything.
+ * a type-erased parser declares cuts itself when its closure may hold one (shell does).
+ */
+template <class P>
+constexpr bool declares_cuts() {
+    if constexpr (requires { P::cuts; }) {
+        return P::cuts;
+    } else {
+        return false;
+    }
+}
+
+template <class P>
+struct cuts_of : std::bool_constant<declares_cuts<P>()> {};
+
+template <template <class...> class W, class... A>
+struct cuts_of<W<A...>> : std::bool_constant<declares_cuts<W<A...>>() || (cuts_of<A>::value || ...)> {};
+
+template <class P>
+constexpr static inline bool may_cut = cuts_of<std::remove_cvref_t<P>>::value;
+
+/** rollback point, pushed only where Enabled (see may_cut)
+ * branch, choice and repeat enable it for the alternatives that may cut, so grammars without cuts
+ * neither look the stream state up nor push frames.
+ * inputs other than std::istream hold everything in memory and ignore cuts.
+ */
+template <class I, bool Enabled = true>
+class cut_point {
+public:
+    cut_point(I &, const auto &) {}
+    bool committed() const { return false; }
+};
+
+template <std::derived_from<std::istream> I>
+class cut_point<I, true> {
+    cut_state *state;
+    size_t index;
+
+public:
+    cut_point(I &is, std::streamoff pos) : state(&state_of(is)), index(state->frames.size()) {
+        state->frames.push_back({pos, true});
+    }
+    cut_point(const cut_point &) = delete;
+    ~cut_point() { state->frames.resize(index); }
+    bool committed() const { return !state->frames[index].live; }
+};
+
+/** stream buffer over a forward-only source that keeps what parsers may still rewind to
+ * everything read since the oldest live rollback point is retained; a cut releases the rest.
+ */
+class releasing_streambuf : public std::streambuf {
+    std::streambuf *source;
+    std::vector<char> window;
+    std::streamoff base{0}; // offset of window[0]
+    size_t block;
+    bool end{false};
+
+    // reads one more block from source, false at its end
+    bool fill();
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+public:
+    releasing_streambuf(std::streambuf *_source, size_t _block = 4096) : source(_source), block(_block) {
+        setg(window.data(), window.data(), window.data());
+    }
+
+    // bytes before pos (but not past the read position) can no longer be rewound to
+    void release(std::streamoff pos);
+    size_t retained() const { return window.size(); }
+    std::streamoff released() const { return base; }
+};
+
+/** commits the current alternative
+ * branch, choice and repeat stop trying other alternatives (or items) once a cut inside has run,
+ * and a releasing_streambuf drops the bytes before the oldest rollback point still alive.
+ */
+template <class L = std::nullptr_t>
+class cut {
+public:
+    constexpr static bool cuts = true;
+
+    cut() = default;
+    either<std::nullptr_t, L> operator()(std::istream &is) const;
+    firsts::first_set first() const { return firsts::any(); }
+};
+
+// marks the innermost point committed and releases what no live point can rewind to
+void commit(std::istream &is);
+
+template <class L>
+either<std::nullptr_t, L> cut<L>::operator()(std::istream &is) const {
+    commit(is);
+    return eithers::right(nullptr);
+}
+
+} // namespace tokenizes::cuts
@@ -0,0 +1,127 @@
+#include "combinators.hpp"
+#include "cuts.hpp"
+#include "primitive.hpp"
+#include "repeats.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+using namespace tokenizes::cuts;
+using tokenizes::combinators::branch;
+using tokenizes::combinators::choice;
+using tokenizes::combinators::operator*;
+using tokenizes::primitive::tag;
+using tokenizes::repeats::many0;
+
+namespace cut_tests {
+const static auto call = tag("if") * cut() * tag("(");
+
+TEST(cut, branch) {
+    std::stringstream ss;
+    ss << "ifx";
+    EXPECT_EQ(branch(tag("if") * tag("("), tag("ifx"))(ss).opt_right(), "ifx");
+
+    ss.clear(), ss.seekg(0);
+    EXPECT_TRUE(branch(call, tag("ifx"))(ss).is_left());
+    EXPECT_EQ(ss.get(), 'x');
+}
+
+TEST(cut, choice) {
+    std::stringstream ss;
+    ss << "ifx";
+    EXPECT_TRUE(choice(call, tag("ifx"))(ss).is_left());
+}
+
+TEST(cut, local) {
+    // the cut commits the inner branch only
+    std::stringstream ss;
+    ss << "ifx";
+    EXPECT_EQ(branch(branch(call, tag("if(")), tag("ifx"))(ss).opt_right(), "ifx");
+}
+
+TEST(cut, local_last) {
+    // a cut in the last alternative commits that alternative, not the enclosing one
+    std::stringstream ss;
+    ss << "ifx";
+    EXPECT_EQ(branch(branch(tag("zz"), call), tag("ifx"))(ss).opt_right(), "ifx");
+
+    ss.clear(), ss.seekg(0);
+    EXPECT_EQ(branch(choice(tag("zz"), call), tag("ifx"))(ss).opt_right(), "ifx");
+
+    ss.clear(), ss.seekg(0);
+    EXPECT_EQ(branch(choice(tag("zz"), tag("yy")), tag("ifx"))(ss).opt_right(), "ifx");
+}
+
+TEST(cut, opt_in) {
+    static_assert(may_cut<cut<>>);
+    static_assert(may_cut<decltype(call)>);
+    static_assert(may_cut<decltype(branch(tag("zz"), call))>);
+    static_assert(may_cut<decltype(many0(call))>);
+    static_assert(!may_cut<decltype(tag("if") * tag("("))>);
+    static_assert(!may_cut<decltype(branch(tag("if"), tag("ifx")))>);
+    static_assert(!may_cut<decltype(many0(choice(tag("a"), tag("b"))))>);
+}
+
+TEST(cut, repeat) {
+    const auto statements = many0(tag("a") * cut() * tag(";"));
+    std::stringstream ss;
+    ss << "a;a;b";
+    EXPECT_EQ(statements(ss).opt_right(), std::vector<std::string>({"a;", "a;"}));
+
+    ss.str("a;a;ax");
+    ss.clear();
+    EXPECT_TRUE(statements(ss).is_left());
+}
+
+} // namespace cut_tests
+
+namespace releasing_tests {
+
+static std::string statements(size_t n) {
+    std::string text;
+    for (size_t i = 0; i < n; i++) {
+        text += i % 2 ? "a;" : "bb;";
+    }
+    return text;
+}
+
+TEST(releasing_streambuf, seek) {
+    std::stringbuf source("0123456789");
+    releasing_streambuf buf(&source, 4);
+    std::istream is(&buf);
+    EXPECT_EQ(is.get(), '0');
+    is.seekg(7);
+    EXPECT_EQ(is.get(), '7');
+    is.seekg(2);
+    EXPECT_EQ(is.get(), '2');
+
+    buf.release(5);
+    EXPECT_EQ(buf.released(), 3);
+    is.seekg(1);
+    EXPECT_TRUE(is.fail());
+}
+
+TEST(releasing_streambuf, cut) {
+    const auto statement = branch(tag("a") * cut() * tag(";"), tag("bb") * cut() * tag(";"));
+    const auto parser = tokenizes::repeats::skip_many(statement);
+
+    const std::string text = statements(100000);
+    std::stringbuf source(text);
+    releasing_streambuf buf(&source, 1024);
+    std::istream is(&buf);
+    EXPECT_TRUE(parser(is).is_right());
+    EXPECT_EQ(is.peek(), -1);
+    EXPECT_GT(buf.released(), static_cast<std::streamoff>(text.size() - 2048));
+    EXPECT_LE(buf.retained(), 2048);
+}
+
+TEST(releasing_streambuf, no_cut) {
+    const auto statement = branch(tag("a") * tag(";"), tag("bb") * tag(";"));
+    const std::string text = statements(1000);
+    std::stringbuf source(text);
+    releasing_streambuf buf(&source, 1024);
+    std::istream is(&buf);
+    EXPECT_TRUE(tokenizes::repeats::skip_many(statement)(is).is_right());
+    EXPECT_EQ(buf.released(), 0);
+}
+
+} // namespace releasing_tests
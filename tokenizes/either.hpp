@@ -1,15 +1,17 @@
 #pragma once
 #include <algorithm>
 #include <concepts>
+#include <memory>
 #include <optional>
 #include <stdexcept>
+#include <utility>
 namespace tokenizes::eithers {
 
 template <class R>
 struct right {
     R value;
     right(const R &_value) : value(_value) {}
-    right(R &&_value) : value(_value) {}
+    right(R &&_value) : value(std::move(_value)) {}
     R &operator*() { return value; }
     const R &operator*() const { return value; }
     R *operator->() { return &value; }
@@ -20,7 +22,7 @@ template <class L>
 struct left {
     L value;
     left(const L &_value) : value(_value) {}
-    left(L &&_value) : value(_value) {}
+    left(L &&_value) : value(std::move(_value)) {}
     L &operator*() { return value; }
     const L &operator*() const { return value; }
     L *operator->() { return &value; }
@@ -29,11 +31,28 @@ struct left {
 
 enum class either_mode { right, none, left };
 
+/** copy of x on x's own allocator
+ * a plain copy of an allocator-aware value asks select_on_container_copy_construction, which for
+ * std::pmr containers is the default resource; uses-allocator construction keeps the arena x came from.
+ */
+template <class T>
+concept allocator_aware = requires(const T &x) { x.get_allocator(); } &&
+                          std::uses_allocator_v<T, decltype(std::declval<const T &>().get_allocator())>;
+
+template <class T>
+T copy_of(const T &x) {
+    if constexpr (allocator_aware<T>) {
+        return std::make_obj_using_allocator<T>(x.get_allocator(), x);
+    } else {
+        return T(x);
+    }
+}
+
 template <std::destructible R, std::destructible L>
 class either {
     constexpr static size_t max_size = std::max(sizeof(right<R>), sizeof(left<L>));
     either_mode mode{either_mode::none};
-    std::byte memory[max_size];
+    alignas(R) alignas(L) std::byte memory[max_size];
 
 public:
     using right_t = R;
@@ -41,20 +60,48 @@ public:
     either() : mode(either_mode::none) {}
     template <std::constructible_from<R> IR>
     either(right<IR> &&_right) : mode(either_mode::right) {
-        new (memory) R(*_right);
+        new (memory) R(std::move(*_right));
     }
     template <std::constructible_from<L> IL>
     either(left<IL> &&_left) : mode(either_mode::left) {
-        new (memory) L(*_left);
+        new (memory) L(std::move(*_left));
     }
     template <std::constructible_from<R> IR, std::constructible_from<L> IL>
     either(either<IR, IL> &&_either) : mode(_either.get_mode()) {
         switch (mode) {
         case either_mode::right:
-            new (memory) R(_either.get_right());
+            new (memory) R(std::move(_either.get_right()));
+            return;
+        case either_mode::left:
+            new (memory) L(std::move(_either.get_left()));
+            return;
+        case either_mode::none:
+            return;
+        default:
+            throw std::domain_error("mode domain error");
+        }
+    }
+    either(const either &_either) : mode(_either.mode) {
+        switch (mode) {
+        case either_mode::right:
+            new (memory) R(copy_of(_either.get_right()));
+            return;
+        case either_mode::left:
+            new (memory) L(copy_of(_either.get_left()));
+            return;
+        case either_mode::none:
+            return;
+        default:
+            throw std::domain_error("mode domain error");
+        }
+    }
+    either(either &&_either) : mode(_either.mode) {
+        switch (mode) {
+        case either_mode::right:
+            new (memory) R(std::move(_either.get_right()));
             return;
         case either_mode::left:
-            new (memory) L(_either.get_left());
+            new (memory) L(std::move(_either.get_left()));
             return;
         case either_mode::none:
             return;
@@ -64,23 +111,44 @@ public:
     }
     ~either() { reset(); }
 
+    either &operator=(const either &_either) {
+        if (this == &_either) {
+            return *this;
+        }
+        reset();
+        switch (_either.mode) {
+        case either_mode::right:
+            new (memory) R(copy_of(_either.get_right()));
+            break;
+        case either_mode::left:
+            new (memory) L(copy_of(_either.get_left()));
+            break;
+        case either_mode::none:
+            break;
+        default:
+            throw std::domain_error("mode domain error");
+        }
+        mode = _either.mode;
+        return *this;
+    }
+
     // operator =
     template <std::constructible_from<R> IR, std::constructible_from<L> IL>
     either &operator=(either<IR, IL> &&_either) {
         reset();
-        mode = _either.mode;
-        switch (mode) {
+        switch (_either.get_mode()) {
         case either_mode::right:
-            new (memory) R(std::move(*reinterpret_cast<IR *>(_either.memory)));
+            new (memory) R(std::move(_either.get_right()));
             break;
         case either_mode::left:
-            new (memory) L(std::move(*reinterpret_cast<IL *>(_either.memory)));
+            new (memory) L(std::move(_either.get_left()));
             break;
         case either_mode::none:
             break;
         default:
             throw std::domain_error("mode domain error");
         }
+        mode = _either.get_mode();
         _either.reset();
         return *this;
     }
@@ -127,13 +195,13 @@ public:
         if (mode != either_mode::right) {
             return std::nullopt;
         }
-        return *reinterpret_cast<const R *>(memory);
+        return copy_of(*reinterpret_cast<const R *>(memory));
     }
     std::optional<L> opt_left() const {
         if (mode != either_mode::left) {
             return std::nullopt;
         }
-        return *reinterpret_cast<const L *>(memory);
+        return copy_of(*reinterpret_cast<const L *>(memory));
     }
     // get-*
     R &get_right() {
@@ -170,13 +238,13 @@ public:
 
     // into_-*
     right<R> into_right() {
-        const right<R> result = (std::move(get_right()));
+        right<R> result(std::move(get_right()));
         reset();
         return result;
     }
 
     left<L> into_left() {
-        const left<L> result(std::move(get_left()));
+        left<L> result(std::move(get_left()));
         reset();
         return result;
     }
@@ -1,7 +1,10 @@
 #include "primitive.hpp"
 #include "repeats.hpp"
 #include "gtest/gtest.h"
+#include <memory>
+#include <memory_resource>
 #include <sstream>
+#include <vector>
 using namespace tokenizes::eithers;
 
 TEST(either, right_prop) {
@@ -91,3 +94,38 @@ TEST(either, map_left) {
     auto f = e.map_left([](const std::string &x) { return x + "b"; });
     EXPECT_EQ(f.opt_left(), "ab");
 }
+
+TEST(either, copy) {
+    const either<std::string, int> e = right(std::string("abc"));
+    either<std::string, int> x = e;
+    EXPECT_EQ(x.opt_right(), "abc");
+    EXPECT_EQ(e.opt_right(), "abc");
+
+    x = either<std::string, int>(left(1));
+    EXPECT_EQ(x.opt_left(), 1);
+    x = e;
+    EXPECT_EQ(x.opt_right(), "abc");
+}
+
+TEST(either, copy_allocator) {
+    std::pmr::monotonic_buffer_resource arena;
+    const either<std::pmr::vector<int>, int> e = right(std::pmr::vector<int>({1, 2, 3}, &arena));
+    either<std::pmr::vector<int>, int> x = e;
+    EXPECT_EQ(x.get_right().get_allocator().resource(), &arena);
+    EXPECT_EQ(e.opt_right()->get_allocator().resource(), &arena);
+
+    x = either<std::pmr::vector<int>, int>(left(1));
+    x = e;
+    EXPECT_EQ(x.get_right().get_allocator().resource(), &arena);
+}
+
+TEST(either, move_only) {
+    either<std::unique_ptr<int>, int> e = right(std::make_unique<int>(1));
+    either<std::unique_ptr<int>, int> x = std::move(e);
+    ASSERT_TRUE(x.is_right());
+    EXPECT_EQ(*x.get_right(), 1);
+
+    const right<std::unique_ptr<int>> r = x.into_right();
+    EXPECT_EQ(**r, 1);
+    EXPECT_TRUE(x.is_none());
+}
@@ -0,0 +1,219 @@
+#include "expressions.hpp"
+#include <stdexcept>
+#include <string_view>
+#include <variant>
+namespace tokenizes::expressions {
+
+using eithers::left;
+using eithers::right;
+
+size_t binding_table::index(token_id id) {
+    if (!tokens::is_mark(id)) {
+        return mark_count;
+    }
+    return static_cast<uint32_t>(id) - tokens::token_id_marks;
+}
+
+binding_table &binding_table::set_infix(token_id id, uint8_t left, uint8_t right) {
+    const size_t i = index(id);
+    if (i >= mark_count) {
+        throw std::out_of_range("infix must be a mark");
+    }
+    return infixes[i] = binding{left, right}, *this;
+}
+
+binding_table &binding_table::set_prefix(token_id id, uint8_t power) {
+    const size_t i = index(id);
+    if (i >= mark_count) {
+        throw std::out_of_range("prefix must be a mark");
+    }
+    return prefixes[i] = power, *this;
+}
+
+binding binding_table::infix(token_id id) const {
+    const size_t i = index(id);
+    return i < mark_count ? infixes[i] : binding();
+}
+
+uint8_t binding_table::prefix(token_id id) const {
+    const size_t i = index(id);
+    return i < mark_count ? prefixes[i] : 0;
+}
+
+const binding_table &binding_table::standard() {
+    const static binding_table table = binding_table()
+                                           .set_infix(token_id::assign, 2, 1)
+                                           .set_infix(token_id::add, 3, 4)
+                                           .set_infix(token_id::sub, 3, 4)
+                                           .set_infix(token_id::mul, 5, 6)
+                                           .set_infix(token_id::div, 5, 6)
+                                           .set_infix(token_id::mod, 5, 6)
+                                           .set_prefix(token_id::add, 7)
+                                           .set_prefix(token_id::sub, 7);
+    return table;
+}
+
+static bool is_operand(token_id id) {
+    switch (id) {
+    case token_id::variable:
+    case token_id::boolean:
+    case token_id::integer:
+    case token_id::real:
+    case token_id::text:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, expression_errors e) {
+    switch (e) {
+    case expression_errors::empty:
+        return os << "empty";
+    case expression_errors::unexpected_token:
+        return os << "unexpected_token";
+    case expression_errors::unexpected_end:
+        return os << "unexpected_end";
+    case expression_errors::unbalanced_paren:
+        return os << "unbalanced_paren";
+    default:
+        return os << "unknown";
+    }
+}
+
+either<expression, expression_errors> expression_parser::operator()(std::span<const token> tokens) const {
+    struct pending {
+        token_id op;
+        uint8_t power; // binding power towards the right operand
+        enum { infix, prefix, paren } kind;
+        uint32_t token;
+    };
+
+    expression e;
+    e.nodes.reserve(tokens.size());
+    std::vector<pending> operators;
+    std::vector<uint32_t> operands;
+
+    const auto reduce = [&e, &operators, &operands]() {
+        const pending p = operators.back();
+        operators.pop_back();
+
+        const uint32_t rhs = operands.back();
+        operands.pop_back();
+        if (p.kind == pending::prefix) {
+            e.nodes.push_back(node{node_kind::unary, p.op, p.token, rhs, rhs});
+        } else {
+            const uint32_t lhs = operands.back();
+            operands.pop_back();
+            e.nodes.push_back(node{node_kind::binary, p.op, p.token, lhs, rhs});
+        }
+        operands.push_back(static_cast<uint32_t>(e.nodes.size() - 1));
+    };
+
+    if (tokens.empty()) {
+        return left(expression_errors::empty);
+    }
+
+    bool expect_operand = true;
+    for (uint32_t i = 0; i < tokens.size(); i++) {
+        const token_id id = tokens[i].id;
+
+        // prefix position: operand, '(' or prefix operator
+        if (expect_operand) {
+            if (is_operand(id)) {
+                e.nodes.push_back(node{node_kind::operand, id, i, 0, 0});
+                operands.push_back(static_cast<uint32_t>(e.nodes.size() - 1));
+                expect_operand = false;
+            } else if (id == token_id::lparen) {
+                operators.push_back(pending{id, 0, pending::paren, i});
+            } else if (const uint8_t power = table->prefix(id); power) {
+                operators.push_back(pending{id, power, pending::prefix, i});
+            } else {
+                return left(expression_errors::unexpected_token);
+            }
+            continue;
+        }
+
+        // infix position: ')' or infix operator
+        if (id == token_id::rparen) {
+            while (!operators.empty() && operators.back().kind != pending::paren) {
+                reduce();
+            }
+            if (operators.empty()) {
+                return left(expression_errors::unbalanced_paren);
+            }
+            operators.pop_back();
+            continue;
+        }
+
+        const binding b = table->infix(id);
+        if (!b.left) {
+            return left(expression_errors::unexpected_token);
+        }
+        while (!operators.empty() && operators.back().kind != pending::paren && operators.back().power > b.left) {
+            reduce();
+        }
+        operators.push_back(pending{id, b.right, pending::infix, i});
+        expect_operand = true;
+    }
+
+    if (expect_operand) {
+        return left(expression_errors::unexpected_end);
+    }
+    while (!operators.empty()) {
+        if (operators.back().kind == pending::paren) {
+            return left(expression_errors::unbalanced_paren);
+        }
+        reduce();
+    }
+    e.root = operands.back();
+    return right(std::move(e));
+}
+
+void print(std::ostream &os, const expression &e, std::span<const token> tokens) {
+    // a node, or a closing paren once its children are printed
+    struct item {
+        uint32_t node;
+        bool close;
+    };
+
+    std::vector<item> stack{{e.root, false}};
+    bool space = false;
+    while (!stack.empty()) {
+        const item it = stack.back();
+        stack.pop_back();
+        if (it.close) {
+            os << ")";
+            space = true;
+            continue;
+        }
+
+        if (space) os << " ";
+        const node &n = e.nodes[it.node];
+        switch (n.kind) {
+        case node_kind::operand:
+            if (const auto *s = std::get_if<tokens::text_t>(&tokens[n.token].value); s) {
+                os << *s;
+            } else {
+                tokens::operator<<(os, tokens[n.token].value);
+            }
+            space = true;
+            break;
+        case node_kind::unary:
+            os << "(" << tokens::mark_of(n.op);
+            stack.push_back({0, true});
+            stack.push_back({n.lhs, false});
+            space = true;
+            break;
+        case node_kind::binary:
+            os << "(" << tokens::mark_of(n.op);
+            stack.push_back({0, true});
+            stack.push_back({n.rhs, false});
+            stack.push_back({n.lhs, false});
+            space = true;
+            break;
+        }
+    }
+}
+
+} // namespace tokenizes::expressions
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include "either.hpp"
+#include "tokens.hpp"
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+namespace tokenizes::expressions {
+
+using eithers::either;
+using tokens::token;
+using tokens::token_id;
+
+// left/right binding power of an infix mark, 0 if the mark is not infix
+struct binding {
+    uint8_t left{0}, right{0};
+};
+
+class binding_table {
+    constexpr static size_t mark_count = 64;
+    std::array<binding, mark_count> infixes{};
+    std::array<uint8_t, mark_count> prefixes{};
+
+    static size_t index(token_id id);
+
+public:
+    binding_table() = default;
+    binding_table &set_infix(token_id id, uint8_t left, uint8_t right);
+    binding_table &set_prefix(token_id id, uint8_t power);
+    binding infix(token_id id) const;
+    uint8_t prefix(token_id id) const;
+
+    // assign (right assoc) < add, sub < mul, div, mod < prefix add, sub
+    static const binding_table &standard();
+};
+
+enum class node_kind : uint8_t { operand, unary, binary };
+
+/** expression node
+ * operands refer to their token by index, so values are never parsed again.
+ * children refer to earlier nodes of the same expression.
+ */
+struct node {
+    node_kind kind;
+    token_id op;
+    uint32_t token;
+    uint32_t lhs, rhs;
+};
+
+struct expression {
+    std::vector<node> nodes;
+    uint32_t root;
+};
+
+// s-expression, e.g. (+ 1 (* 2 3))
+void print(std::ostream &os, const expression &e, std::span<const token> tokens);
+
+enum class expression_errors { empty, unexpected_token, unexpected_end, unbalanced_paren };
+
+std::ostream &operator<<(std::ostream &, expression_errors);
+
+/** operator precedence (pratt) parser over a token sequence
+ * operators and operands live on explicit stacks, so nesting depth never grows the call stack.
+ */
+class expression_parser {
+    const binding_table *table;
+
+public:
+    expression_parser(const binding_table &_table = binding_table::standard()) : table(&_table) {}
+    either<expression, expression_errors> operator()(std::span<const token> tokens) const;
+};
+
+} // namespace tokenizes::expressions
\ No newline at end of file
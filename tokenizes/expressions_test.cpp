@@ -0,0 +1,105 @@
+#include "expressions.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+
+using namespace tokenizes::expressions;
+using tokenizes::tokens::token_parser;
+
+namespace expression_parser_tests {
+
+static std::vector<token> lex(std::string_view text) {
+    const static token_parser parser;
+    std::stringstream ss;
+    ss << text;
+    return parser.tokenize(ss).get_right();
+}
+
+static std::string parse(std::string_view text) {
+    const auto tokens = lex(text);
+    const auto e = expression_parser()(tokens);
+    if (e.is_left()) {
+        std::stringstream ss;
+        ss << e.get_left();
+        return ss.str();
+    }
+    std::stringstream ss;
+    print(ss, e.get_right(), tokens);
+    return ss.str();
+}
+
+TEST(expression_parser, operand) { EXPECT_EQ(parse("1"), "1"); }
+
+TEST(expression_parser, precedence) {
+    EXPECT_EQ(parse("1 + 2 * 3"), "(+ 1 (* 2 3))");
+    EXPECT_EQ(parse("1 * 2 + 3"), "(+ (* 1 2) 3)");
+}
+
+TEST(expression_parser, left_assoc) { EXPECT_EQ(parse("1 - 2 - 3"), "(- (- 1 2) 3)"); }
+
+TEST(expression_parser, right_assoc) {
+    const auto tokens = lex("x = y = 1");
+    const auto e = expression_parser()(tokens);
+    ASSERT_TRUE(e.is_right());
+    const expression &x = e.get_right();
+    EXPECT_EQ(x.nodes[x.root].op, token_id::assign);
+    EXPECT_EQ(x.nodes[x.nodes[x.root].rhs].op, token_id::assign);
+}
+
+TEST(expression_parser, prefix) {
+    EXPECT_EQ(parse("- (1) * 2"), "(* (- 1) 2)");
+    EXPECT_EQ(parse("2 * - 1"), "(* 2 (- 1))");
+}
+
+TEST(expression_parser, unspaced) {
+    EXPECT_EQ(parse("1-2"), "(- 1 2)");
+    EXPECT_EQ(parse("1+-2-3"), "(- (+ 1 -2) 3)");
+    EXPECT_EQ(parse("(1)-2"), "(- 1 2)");
+    // variables print as their symbols
+    EXPECT_EQ(parse("x-1"), parse("x - 1"));
+    EXPECT_EQ(parse("a*-1"), parse("a * -1"));
+    EXPECT_EQ(parse("(x)-1"), parse("x - 1"));
+    EXPECT_EQ(parse("-1-x"), parse("-1 - x"));
+    EXPECT_TRUE(parse("a*-1").ends_with(" -1)"));
+}
+
+TEST(expression_parser, paren) { EXPECT_EQ(parse("(1 + 2) * 3"), "(* (+ 1 2) 3)"); }
+
+TEST(expression_parser, operand_tokens) {
+    const auto tokens = lex("'a' % 2.5");
+    EXPECT_EQ(parse("'a' % 2.5"), "(% a 2.5)");
+    const auto e = expression_parser()(tokens);
+    EXPECT_EQ(e.get_right().nodes[e.get_right().root].token, 1);
+}
+
+TEST(expression_parser, errors) {
+    EXPECT_EQ(parse(""), "empty");
+    EXPECT_EQ(parse("1 +"), "unexpected_end");
+    EXPECT_EQ(parse("1 2"), "unexpected_token");
+    EXPECT_EQ(parse("* 2"), "unexpected_token");
+    EXPECT_EQ(parse("(1"), "unbalanced_paren");
+    EXPECT_EQ(parse("1)"), "unbalanced_paren");
+}
+
+TEST(expression_parser, deep) {
+    std::string text;
+    for (int i = 0; i < 100000; i++) {
+        text += "(";
+    }
+    text += "1";
+    for (int i = 0; i < 100000; i++) {
+        text += ")";
+    }
+    EXPECT_EQ(parse(text), "1");
+}
+
+TEST(binding_table, custom) {
+    const auto table = binding_table().set_infix(token_id::add, 6, 5).set_infix(token_id::mul, 3, 4);
+    const auto tokens = lex("1 * 2 + 3 + 4");
+    const auto e = expression_parser(table)(tokens);
+    std::stringstream ss;
+    print(ss, e.get_right(), tokens);
+    EXPECT_EQ(ss.str(), "(* 1 (+ 2 (+ 3 4)))");
+}
+
+} // namespace expression_parser_tests
@@ -0,0 +1,27 @@
+#pragma once
+#include <bitset>
+#include <concepts>
+namespace tokenizes::firsts {
+
+/** FIRST set: bytes a successful parse may start with.
+ * parsers that may succeed without consuming (or can not tell) report every byte.
+ */
+using first_set = std::bitset<256>;
+
+template <class P>
+concept has_first = requires(const P &p) {
+    { p.first() } -> std::convertible_to<first_set>;
+};
+
+static inline first_set any() { return first_set().set(); }
+
+template <class P>
+first_set first_of(const P &p) {
+    if constexpr (has_first<P>) {
+        return p.first();
+    } else {
+        return any();
+    }
+}
+
+} // namespace tokenizes::firsts
\ No newline at end of file
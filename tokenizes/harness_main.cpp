@@ -0,0 +1,246 @@
+// throughput regression harness: runs the tokenizer engines over one corpus
+//   tokenize_harness [--size 16M] [--mix balanced] [--seed 0] [--corpus file] [--engines stream,span,...]
+//                    [--repeat 3] [--save out.json] [--baseline base.json] [--tolerance 0.05]
+// the stream and pipeline engines read the corpus as a stream, generated or read block by block;
+// the others need it in memory, and it is built once before the first of them runs.
+// with --baseline, exits with 1 when an engine regressed or is missing.
+#include "allocs.hpp"
+#include "corpora.hpp"
+#include "harnesses.hpp"
+#include "lazies.hpp"
+#include "perfs.hpp"
+#include "pipelines.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace tokenizes;
+using tokenizes::eithers::either;
+
+namespace {
+
+// tokens produced by one run, or an error
+using result = either<uint64_t, std::string>;
+// engines reading a stream of the corpus, which then is never resident as a whole
+using stream_engine = std::function<result(std::istream &is)>;
+// engines over the corpus as contiguous text
+using text_engine = std::function<result(std::string_view text)>;
+using engine = std::variant<stream_engine, text_engine>;
+
+std::vector<std::pair<std::string, engine>> engines() {
+    static const tokens::token_parser parser;
+    static const tokens::span_lexer lexer;
+    static tokens::token_context context;
+    static const pipelines::token_pipeline pipeline;
+
+    // counts what a run returned, passing errors through
+    const auto count = [](auto &&e) -> result {
+        if (e.is_right()) return eithers::right<uint64_t>(e.get_right().size());
+        return eithers::left(std::string(e.get_left()));
+    };
+    return {
+        {"stream", stream_engine([count](std::istream &is) { return count(parser.tokenize(is)); })},
+        {"span", text_engine([count](std::string_view text) { return count(parser.tokenize(text)); })},
+        {"context", text_engine([count](std::string_view text) { return count(parser.tokenize(text, context)); })},
+        {"lazy", text_engine([count](std::string_view text) { return count(lexer.tokenize(text)); })},
+        {"pipeline", stream_engine([](std::istream &is) -> result {
+             uint64_t n = 0;
+             auto e = pipeline.run(is, [&n](const pipelines::token_chunk &chunk) { n += chunk.tokens.size(); });
+             if (e.is_left()) return eithers::left(std::move(e.get_left()));
+             return eithers::right(n);
+         })},
+    };
+}
+
+// a corpus file, or one generated from options
+struct corpus_source {
+    std::string file;
+    corpora::corpus_options options;
+    uint64_t bytes{0}; // of the file, or asked of the generator
+
+    // a fresh stream over the whole corpus, or null
+    std::unique_ptr<std::streambuf> open() const {
+        if (file.empty()) return std::make_unique<corpora::corpus_streambuf>(options, bytes);
+        auto buffer = std::make_unique<std::filebuf>();
+        if (!buffer->open(file, std::ios::in | std::ios::binary)) return nullptr;
+        return buffer;
+    }
+    // the corpus in memory, for the text engines
+    std::string text() const {
+        if (file.empty()) return corpora::corpus_generator(options).generate(bytes);
+        std::ifstream in(file, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+};
+
+std::vector<std::string> split(std::string_view list) {
+    std::vector<std::string> items;
+    for (size_t begin = 0; begin <= list.size();) {
+        const size_t end = std::min(list.find(',', begin), list.size());
+        if (end > begin) items.emplace_back(list.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return items;
+}
+
+int usage(const char *name) {
+    std::cerr << "usage: " << name
+              << " [--size 16M] [--mix balanced|numeric|textual|marks] [--seed n] [--corpus file]"
+                 " [--engines stream,span,context,lazy,pipeline] [--repeat n]"
+                 " [--save file] [--baseline file] [--tolerance 0.05]\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string size = "16M", mix = "balanced", seed = "0", corpus, save, baseline;
+    std::string selected = "stream,span,context,lazy,pipeline";
+    int repeat = 3;
+    double tolerance = 0.05;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc) return usage(argv[0]);
+        const char *value = argv[++i];
+        if (arg == "--size") {
+            size = value;
+        } else if (arg == "--mix") {
+            mix = value;
+        } else if (arg == "--seed") {
+            seed = value;
+        } else if (arg == "--corpus") {
+            corpus = value;
+        } else if (arg == "--engines") {
+            selected = value;
+        } else if (arg == "--repeat") {
+            repeat = std::max(1, std::atoi(value));
+        } else if (arg == "--save") {
+            save = value;
+        } else if (arg == "--baseline") {
+            baseline = value;
+        } else if (arg == "--tolerance") {
+            tolerance = std::atof(value);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    harnesses::harness_report report;
+    corpus_source source;
+    if (!corpus.empty()) {
+        std::error_code error;
+        source.file = corpus;
+        source.bytes = std::filesystem::file_size(corpus, error);
+        if (error) {
+            std::cerr << "cannot open " << corpus << '\n';
+            return 1;
+        }
+        report.corpus = {{"file", corpus}, {"bytes", std::to_string(source.bytes)}};
+    } else {
+        const auto bytes = corpora::size_of(size);
+        const auto m = corpora::mix_of(mix);
+        if (!bytes || !m) return usage(argv[0]);
+        source.options = {.seed = std::strtoull(seed.c_str(), nullptr, 10), .mix = *m};
+        source.bytes = *bytes;
+        report.corpus = {{"seed", seed}, {"size", size}, {"mix", mix}};
+    }
+
+    const auto all = engines();
+    const perfs::perf_counters counters;
+    if (!counters.any()) {
+        std::cerr << "hardware counters unavailable, wall clock only\n";
+    }
+    std::string text; // materialized for the first text engine, after the stream engines that come before it
+    for (const std::string &name : split(selected)) {
+        const auto found = std::find_if(all.begin(), all.end(), [&](const auto &e) { return e.first == name; });
+        if (found == all.end()) {
+            std::cerr << "unknown engine " << name << '\n';
+            return 2;
+        }
+        const auto *over_text = std::get_if<text_engine>(&found->second);
+        if (over_text && source.bytes > UINT32_MAX) {
+            std::cerr << name << ": skipped, token offsets are 32 bits\n";
+            continue;
+        }
+        if (over_text && text.empty()) text = source.text();
+
+        harnesses::engine_result r;
+        harnesses::reset_peak_rss();
+        r.baseline_rss_kb = harnesses::rss_kb();
+        for (int k = 0; k < repeat; k++) {
+            std::unique_ptr<std::streambuf> buffer;
+            if (!over_text && !(buffer = source.open())) {
+                std::cerr << "cannot open " << corpus << '\n';
+                return 1;
+            }
+            std::istream is(buffer.get());
+
+            // the pipeline allocates on its own threads too
+            const allocs::allocation_counts before = allocs::process_counts();
+            const perfs::perf_sample start = counters.sample();
+            const auto begin = std::chrono::steady_clock::now();
+            const auto e = over_text ? (*over_text)(text) : std::get<stream_engine>(found->second)(is);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            const perfs::perf_sample perf = counters.sample() - start;
+            if (e.is_left()) {
+                std::cerr << name << ": " << e.get_left() << '\n';
+                return 1;
+            }
+            if (k == 0 || elapsed.count() < r.seconds) {
+                r.seconds = elapsed.count();
+                r.tokens = e.get_right();
+                const allocs::allocation_counts used = allocs::process_counts() - before;
+                r.allocations = used.allocations;
+                r.allocated_bytes = used.bytes;
+                r.perf = perf;
+            }
+            // the stream is at the end of the corpus
+            r.bytes = over_text ? text.size()
+                                : static_cast<uint64_t>(buffer->pubseekoff(0, std::ios::cur, std::ios::in));
+        }
+        r.peak_rss_kb = harnesses::peak_rss_kb();
+        report.engines[name] = r;
+
+        std::cout << name << ": " << r.mb_per_s() << " MB/s, " << r.tokens_per_s() << " tokens/s, peak RSS +"
+                  << r.rss_growth_kb() << " KiB over " << r.baseline_rss_kb << " KiB, " << r.allocations
+                  << " allocations (" << r.allocated_bytes << " bytes)";
+        if (const auto &cycles = r.perf[perfs::perf_event::cycles]) {
+            std::cout << ", " << static_cast<double>(*cycles) / r.bytes << " cycles/byte";
+        }
+        if (const auto ipc = r.perf.ipc()) {
+            std::cout << ", IPC " << *ipc;
+        }
+        for (const auto event : {perfs::perf_event::branch_misses, perfs::perf_event::cache_misses}) {
+            if (const auto &count = r.perf[event]; count && r.tokens) {
+                std::cout << ", " << static_cast<double>(*count) / r.tokens << ' ' << perfs::name_of(event) << "/token";
+            }
+        }
+        std::cout << '\n';
+    }
+
+    if (!save.empty()) {
+        std::ofstream out(save);
+        harnesses::write_json(out, report);
+    }
+    if (!baseline.empty()) {
+        std::ifstream in(baseline);
+        const auto base = harnesses::read_json(in);
+        if (base.is_left()) {
+            std::cerr << baseline << ": " << base.get_left() << '\n';
+            return 1;
+        }
+        return harnesses::compare(base.get_right(), report, tolerance, std::cout) ? 1 : 0;
+    }
+    return 0;
+}
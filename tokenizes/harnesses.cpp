@@ -0,0 +1,259 @@
+#include "harnesses.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <optional>
+#include <sys/resource.h>
+namespace tokenizes::harnesses {
+
+using tokenizes::eithers::left;
+using tokenizes::eithers::right;
+
+namespace {
+
+constexpr const char *fields[]{"bytes", "tokens", "seconds", "mb_per_s", "tokens_per_s",
+                               "peak_rss_kb", "baseline_rss_kb", "allocations", "allocated_bytes"};
+
+// perf event names with underscores, as JSON fields
+std::string field_of(perfs::perf_event event) {
+    std::string name(perfs::name_of(event));
+    std::replace(name.begin(), name.end(), '-', '_');
+    return name;
+}
+
+void quoted(std::ostream &os, const std::string &s) {
+    os << '"';
+    for (const char c : s) {
+        if (c == '"' || c == '\\') os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+/** flattens a JSON document into dotted paths ("engines.span.mb_per_s") and scalar texts
+ * enough for the files write_json produces; arrays are indexed like objects.
+ */
+class flat_reader {
+    std::string_view text;
+    size_t i{0};
+    std::map<std::string, std::string> &out;
+
+    void skip() {
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) i++;
+    }
+    bool eat(char c) {
+        skip();
+        if (i < text.size() && text[i] == c) {
+            i++;
+            return true;
+        }
+        return false;
+    }
+    bool string(std::string &s) {
+        if (!eat('"')) return false;
+        for (; i < text.size() && text[i] != '"'; i++) {
+            if (text[i] == '\\' && ++i >= text.size()) return false;
+            s += text[i];
+        }
+        return i++ < text.size();
+    }
+    bool value(const std::string &path) {
+        skip();
+        if (i >= text.size()) return false;
+        const std::string prefix = path.empty() ? path : path + ".";
+        if (eat('{')) {
+            if (eat('}')) return true;
+            do {
+                std::string key;
+                if (!string(key) || !eat(':') || !value(prefix + key)) return false;
+            } while (eat(','));
+            return eat('}');
+        }
+        if (eat('[')) {
+            if (eat(']')) return true;
+            size_t index = 0;
+            do {
+                if (!value(prefix + std::to_string(index++))) return false;
+            } while (eat(','));
+            return eat(']');
+        }
+        if (text[i] == '"') {
+            std::string s;
+            if (!string(s)) return false;
+            out[path] = s;
+            return true;
+        }
+        const size_t begin = i;
+        while (i < text.size() && text[i] != ',' && text[i] != '}' && text[i] != ']' &&
+               !std::isspace(static_cast<unsigned char>(text[i]))) {
+            i++;
+        }
+        out[path] = std::string(text.substr(begin, i - begin));
+        return i > begin;
+    }
+
+public:
+    flat_reader(std::string_view _text, std::map<std::string, std::string> &_out) : text(_text), out(_out) {}
+    bool read() {
+        if (!value("")) return false;
+        skip();
+        return i == text.size();
+    }
+    size_t position() const { return i; }
+};
+
+} // namespace
+
+void write_json(std::ostream &os, const harness_report &report) {
+    os << "{\n  \"corpus\": {";
+    const char *separator = "\n";
+    for (const auto &[key, value] : report.corpus) {
+        os << separator << "    ";
+        quoted(os, key);
+        os << ": ";
+        quoted(os, value);
+        separator = ",\n";
+    }
+    os << "\n  },\n  \"engines\": {";
+    separator = "\n";
+    for (const auto &[name, r] : report.engines) {
+        os << separator << "    ";
+        quoted(os, name);
+        const double values[]{static_cast<double>(r.bytes), static_cast<double>(r.tokens), r.seconds,
+                              r.mb_per_s(), r.tokens_per_s(), static_cast<double>(r.peak_rss_kb),
+                              static_cast<double>(r.baseline_rss_kb), static_cast<double>(r.allocations), static_cast<double>(r.allocated_bytes)};
+        os << ": {";
+        for (size_t k = 0; k < std::size(fields); k++) {
+            os << (k ? ", " : "") << '"' << fields[k] << "\": " << std::setprecision(12) << values[k];
+        }
+        for (size_t k = 0; k < perfs::event_count; k++) {
+            if (const auto &count = r.perf.counts[k]) {
+                os << ", \"" << field_of(static_cast<perfs::perf_event>(k)) << "\": " << *count;
+            }
+        }
+        os << "}";
+        separator = ",\n";
+    }
+    os << "\n  }\n}\n";
+}
+
+either<harness_report, std::string> read_json(std::istream &is) {
+    const std::string text{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+    std::map<std::string, std::string> flat;
+    flat_reader reader(text, flat);
+    if (!reader.read()) {
+        return left("malformed JSON at " + std::to_string(reader.position()));
+    }
+
+    harness_report report;
+    for (const auto &[path, value] : flat) {
+        if (path.starts_with("corpus.")) {
+            report.corpus[path.substr(7)] = value;
+            continue;
+        }
+        if (!path.starts_with("engines.")) continue;
+        const size_t dot = path.rfind('.');
+        if (dot <= 8) continue;
+
+        engine_result &r = report.engines[path.substr(8, dot - 8)];
+        const std::string field = path.substr(dot + 1);
+        double number = 0;
+        if (std::from_chars(value.data(), value.data() + value.size(), number).ec != std::errc()) {
+            return left(path + " is not a number");
+        }
+        if (field == "bytes") {
+            r.bytes = static_cast<uint64_t>(number);
+        } else if (field == "tokens") {
+            r.tokens = static_cast<uint64_t>(number);
+        } else if (field == "seconds") {
+            r.seconds = number;
+        } else if (field == "peak_rss_kb") {
+            r.peak_rss_kb = static_cast<uint64_t>(number);
+        } else if (field == "baseline_rss_kb") {
+            r.baseline_rss_kb = static_cast<uint64_t>(number);
+        } else if (field == "allocations") {
+            r.allocations = static_cast<uint64_t>(number);
+        } else if (field == "allocated_bytes") {
+            r.allocated_bytes = static_cast<uint64_t>(number);
+        }
+        for (size_t k = 0; k < perfs::event_count; k++) {
+            if (field == field_of(static_cast<perfs::perf_event>(k))) {
+                r.perf.counts[k] = static_cast<uint64_t>(number);
+            }
+        }
+        // rates are derived from bytes, tokens and seconds
+    }
+    return right(std::move(report));
+}
+
+bool compare(const harness_report &baseline, const harness_report &current, double tolerance, std::ostream &os) {
+    if (baseline.corpus != current.corpus) {
+        os << "warning: the baseline was measured on a different corpus\n";
+    }
+
+    bool regressed = false;
+    os << std::left << std::setw(12) << "engine" << std::right << std::setw(14) << "base MB/s" << std::setw(14)
+       << "MB/s" << std::setw(10) << "change" << std::setw(14) << "base allocs" << std::setw(14) << "allocs"
+       << '\n';
+    for (const auto &[name, now] : current.engines) {
+        const auto found = baseline.engines.find(name);
+        if (found == baseline.engines.end()) {
+            os << std::left << std::setw(12) << name << std::right << "  (not in baseline)\n";
+            continue;
+        }
+        const engine_result &base = found->second;
+        const double change = base.mb_per_s() > 0 ? now.mb_per_s() / base.mb_per_s() - 1 : 0;
+        const bool slower = change < -tolerance, allocating = now.allocations > base.allocations;
+        regressed |= slower || allocating;
+
+        os << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(1)
+           << std::setw(14) << base.mb_per_s() << std::setw(14) << now.mb_per_s() << std::setw(9) << change * 100
+           << '%' << std::setw(14) << base.allocations << std::setw(14) << now.allocations;
+        if (slower || allocating) os << "  REGRESSED";
+        os << '\n' << std::defaultfloat;
+    }
+    for (const auto &[name, base] : baseline.engines) {
+        if (current.engines.count(name)) continue;
+        os << std::left << std::setw(12) << name << std::right << "  (not run)  REGRESSED\n";
+        regressed = true;
+    }
+    return regressed;
+}
+
+namespace {
+
+// a "VmHWM:"-like field of /proc/self/status, in KiB
+std::optional<uint64_t> status_kb(std::string_view field) {
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.starts_with(field)) {
+            return std::stoull(line.substr(field.size()));
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+uint64_t peak_rss_kb() {
+    if (const auto kb = status_kb("VmHWM:")) return *kb;
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return static_cast<uint64_t>(usage.ru_maxrss);
+    }
+    return 0;
+}
+
+uint64_t rss_kb() {
+    return status_kb("VmRSS:").value_or(0);
+}
+
+void reset_peak_rss() {
+    // "5" resets VmHWM to the current RSS
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+} // namespace tokenizes::harnesses
@@ -0,0 +1,54 @@
+#pragma once
+#include "either.hpp"
+#include "perfs.hpp"
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+namespace tokenizes::harnesses {
+
+using tokenizes::eithers::either;
+
+// one engine over one corpus: the fastest of the repeated runs
+struct engine_result {
+    uint64_t bytes{0}, tokens{0};
+    double seconds{0};
+    uint64_t peak_rss_kb{0};
+    uint64_t baseline_rss_kb{0}; // resident before the runs: the corpus, when an engine needs it in memory
+    uint64_t allocations{0}, allocated_bytes{0}; // during one run
+    perfs::perf_sample perf{};                   // hardware counters of that run, where available
+
+    double mb_per_s() const { return seconds > 0 ? bytes / seconds / (1 << 20) : 0; }
+    double tokens_per_s() const { return seconds > 0 ? tokens / seconds : 0; }
+    // what the runs themselves added to the resident set
+    uint64_t rss_growth_kb() const { return peak_rss_kb > baseline_rss_kb ? peak_rss_kb - baseline_rss_kb : 0; }
+};
+
+struct harness_report {
+    std::map<std::string, std::string> corpus; // how the corpus was made (seed, size, mix or file)
+    std::map<std::string, engine_result> engines;
+};
+
+/** baseline files
+ * {"corpus": {...}, "engines": {"span": {"mb_per_s": ..., ...}, ...}}; read accepts any JSON of that shape.
+ * hardware counters are written as cycles, instructions, branch_misses and cache_misses when they were counted.
+ */
+void write_json(std::ostream &os, const harness_report &report);
+either<harness_report, std::string> read_json(std::istream &is);
+
+/** prints current against baseline, engine by engine
+ * a regression is throughput (MB/s) down by more than tolerance, more allocations per run,
+ * or an engine of the baseline missing from current.
+ * returns whether any engine regressed.
+ */
+bool compare(const harness_report &baseline, const harness_report &current, double tolerance, std::ostream &os);
+
+// peak resident set since the last reset_peak_rss, in KiB (0 if unknown)
+uint64_t peak_rss_kb();
+// current resident set, in KiB (0 if unknown)
+uint64_t rss_kb();
+// restarts the peak where the kernel allows it (Linux clear_refs), otherwise the peak is that of the process
+void reset_peak_rss();
+
+} // namespace tokenizes::harnesses
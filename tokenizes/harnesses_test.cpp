@@ -0,0 +1,77 @@
+#include "harnesses.hpp"
+
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+
+using namespace tokenizes::harnesses;
+
+namespace harnesses_tests {
+
+harness_report sample() {
+    harness_report report;
+    report.corpus = {{"seed", "0"}, {"size", "16M"}, {"mix", "balanced"}};
+    report.engines["span"] = {.bytes = 1 << 20, .tokens = 1000, .seconds = 0.5, .peak_rss_kb = 2048, .baseline_rss_kb = 1536,
+                              .allocations = 3};
+    report.engines["lazy"] = {.bytes = 1 << 20, .tokens = 1000, .seconds = 0.25};
+    return report;
+}
+
+TEST(json, round_trip) {
+    std::stringstream ss;
+    write_json(ss, sample());
+    const auto read = read_json(ss);
+    ASSERT_TRUE(read.is_right()) << read.get_left();
+
+    const harness_report &r = read.get_right();
+    EXPECT_EQ(r.corpus, sample().corpus);
+    ASSERT_EQ(r.engines.size(), 2);
+    EXPECT_EQ(r.engines.at("span").tokens, 1000);
+    EXPECT_EQ(r.engines.at("span").allocations, 3);
+    EXPECT_EQ(r.engines.at("span").rss_growth_kb(), 512);
+    EXPECT_DOUBLE_EQ(r.engines.at("span").mb_per_s(), 2.0);
+    EXPECT_DOUBLE_EQ(r.engines.at("lazy").tokens_per_s(), 4000.0);
+}
+
+TEST(json, rejects_malformed) {
+    std::istringstream truncated(R"({"engines": {"span": {"bytes": 1)");
+    EXPECT_TRUE(read_json(truncated).is_left());
+    std::istringstream text(R"({"engines": {"span": {"bytes": "many"}}})");
+    EXPECT_EQ(read_json(text).get_left(), "engines.span.bytes is not a number");
+}
+
+TEST(compare, flags_regressions) {
+    const harness_report base = sample();
+    std::ostringstream os;
+    EXPECT_FALSE(compare(base, base, 0.05, os));
+
+    harness_report slower = base;
+    slower.engines["lazy"].seconds = 0.3; // 17% slower
+    EXPECT_TRUE(compare(base, slower, 0.05, os));
+    EXPECT_FALSE(compare(base, slower, 0.25, os));
+
+    harness_report allocating = base;
+    allocating.engines["span"].allocations = 4;
+    std::ostringstream out;
+    EXPECT_TRUE(compare(base, allocating, 0.05, out));
+    EXPECT_NE(out.str().find("REGRESSED"), std::string::npos);
+}
+
+TEST(compare, flags_missing_engines) {
+    const harness_report base = sample();
+    harness_report fewer = base;
+    fewer.engines.erase("lazy");
+    std::ostringstream os;
+    EXPECT_TRUE(compare(base, fewer, 0.05, os));
+    EXPECT_NE(os.str().find("(not run)  REGRESSED"), std::string::npos) << os.str();
+    EXPECT_FALSE(compare(fewer, base, 0.05, os));
+}
+
+TEST(peak_rss, is_reported) {
+    reset_peak_rss();
+    EXPECT_GT(peak_rss_kb(), 0);
+    EXPECT_GT(rss_kb(), 0);
+    EXPECT_GE(peak_rss_kb(), rss_kb());
+}
+
+} // namespace harnesses_tests
@@ -0,0 +1,88 @@
+#pragma once
+#include "primitive.hpp"
+#include <concepts>
+#include <cstddef>
+#include <istream>
+#include <span>
+#include <streambuf>
+#include <string_view>
+#include <utility>
+namespace tokenizes::inputs {
+
+/** random-access input over already materialized items (e.g. tokens)
+ * positions are indices, so a rollback is a single assignment.
+ */
+template <class T>
+class span_input {
+    std::span<const T> items;
+    size_t index{0};
+
+public:
+    using value_type = T;
+
+    span_input(std::span<const T> _items) : items(_items) {}
+    size_t tellg() const { return index; }
+    void seekg(size_t pos) { index = pos; }
+    const T *peek() const { return index < items.size() ? &items[index] : nullptr; }
+    const T *get() { return index < items.size() ? &items[index++] : nullptr; }
+    bool eof() const { return index >= items.size(); }
+    size_t size() const { return items.size(); }
+};
+
+/** read-only, seekable stream buffer over text the caller keeps alive
+ * unlike std::istringstream nothing is copied, and reset() points an existing stream at new text.
+ */
+class view_streambuf : public std::streambuf {
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        switch (dir) {
+        case std::ios_base::beg:
+            return seekpos(off, which);
+        case std::ios_base::cur:
+            return seekpos((gptr() - eback()) + off, which);
+        case std::ios_base::end:
+            return seekpos((egptr() - eback()) + off, which);
+        default:
+            return pos_type(off_type(-1));
+        }
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        const off_type off = pos;
+        if (!(which & std::ios_base::in) || off < 0 || off > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + off, egptr());
+        return pos;
+    }
+
+public:
+    view_streambuf(std::string_view text = {}) { reset(text); }
+    void reset(std::string_view text) {
+        char *p = const_cast<char *>(text.data());
+        setg(p, p, p + text.size());
+    }
+};
+
+template <class I>
+using position_of = decltype(std::declval<I &>().tellg());
+
+// tellg/seekg, tolerating the eof state a std::istream is left in by peek()
+template <class I>
+position_of<I> tell(I &is) {
+    if constexpr (std::derived_from<I, std::istream>) {
+        return primitive::tell(is);
+    } else {
+        return is.tellg();
+    }
+}
+
+template <class I>
+void rewind(I &is, position_of<I> pos) {
+    if constexpr (std::derived_from<I, std::istream>) {
+        primitive::rewind(is, pos);
+    } else {
+        is.seekg(pos);
+    }
+}
+
+} // namespace tokenizes::inputs
\ No newline at end of file
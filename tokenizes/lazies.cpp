@@ -0,0 +1,289 @@
+#include "lazies.hpp"
+#include "primitive.hpp"
+#include <stdexcept>
+namespace tokenizes::tokens {
+
+using eithers::left;
+using eithers::right;
+using lexer = token_parser::lexer;
+
+value_t lazy_tokens::decode(const compact_token &t) const {
+    const std::string_view span = source.substr(t.offset, t.length);
+    switch (t.id) {
+    case token_id::variable:
+        return table->intern(span);
+    case token_id::boolean:
+        return span == "true";
+    case token_id::integer: {
+        size_t used = 0;
+        const auto e = primitive::integer_from<int>(span, used);
+        if (e.is_left()) throw std::logic_error("integer was not validated");
+        return e.get_right();
+    }
+    case token_id::real: {
+        const auto e = primitive::real_from<float>(span);
+        if (e.is_left()) throw std::logic_error("real was not validated");
+        return e.get_right();
+    }
+    case token_id::text: {
+        auto e = primitive::unescape(span.substr(1, span.size() - 2));
+        if (e.is_left()) throw std::logic_error("text was not validated");
+        return text_t(e.get_right());
+    }
+    default:
+        return std::monostate();
+    }
+}
+
+value_t lazy_tokens::value(size_t i) const {
+    if (!caching) {
+        return decode(tokens[i]);
+    }
+    if (cache.size() != tokens.size()) {
+        cache.resize(tokens.size());
+    }
+    // marks decode to monostate, which also marks an empty slot; they are cheap to decode again
+    if (std::holds_alternative<std::monostate>(cache[i])) {
+        cache[i] = decode(tokens[i]);
+    }
+    return cache[i];
+}
+
+token lazy_tokens::at(size_t i) const {
+    if (i >= size()) {
+        throw std::out_of_range("token index out of range");
+    }
+    const compact_token &t = tokens[i];
+    return token(t.id, value(i), position(t.offset, t.offset + t.length));
+}
+
+namespace {
+
+bool is_digit(char c) { return '0' <= c && c <= '9'; }
+
+int digit_of(char c, int base) {
+    int d = 36;
+    if (is_digit(c)) d = c - '0';
+    else if ('a' <= c && c <= 'z') d = c - 'a' + 10;
+    else if ('A' <= c && c <= 'Z') d = c - 'A' + 10;
+    return d < base ? d : -1;
+}
+
+size_t digits(std::string_view s, size_t i) {
+    const size_t begin = i;
+    while (i < s.size() && is_digit(s[i])) i++;
+    return i - begin;
+}
+
+// [+-]?[0-9]+\.[0-9]+([eE][+-]?[0-9]+)?, the end of the real or 0; stop is where scanning ended either way
+size_t scan_real(std::string_view s, size_t i, size_t &stop) {
+    const auto fail = [&]() -> size_t {
+        stop = i;
+        return 0;
+    };
+    if (i < s.size() && (s[i] == '+' || s[i] == '-')) i++;
+    size_t n = digits(s, i);
+    if (!n) return fail();
+    i += n;
+    if (i >= s.size() || s[i] != '.') return fail();
+    n = digits(s, ++i);
+    if (!n) return fail();
+    i += n;
+    if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if (i < s.size() && (s[i] == '+' || s[i] == '-')) i++;
+        n = digits(s, i);
+        if (!n) return fail();
+        i += n;
+    }
+    return stop = i;
+}
+
+either<compact_token, token_errors> make(token_id id, size_t begin, size_t end) {
+    return right(compact_token{id, static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin), 0});
+}
+
+// a token reaching the end of source may continue in the next block
+either<compact_token, token_errors> cut(size_t begin, size_t &offset) {
+    offset = begin;
+    return left(token_errors::end_of_input);
+}
+
+either<compact_token, token_errors> number(std::string_view s, size_t begin, size_t &offset, bool more) {
+    // digits that always fit an int, per base
+    const auto safe = [](int base) -> size_t {
+        switch (base) {
+        case 2:
+            return 30;
+        case 4:
+            return 15;
+        case 8:
+            return 10;
+        case 16:
+            return 7;
+        default:
+            return 9;
+        }
+    };
+
+    size_t i = begin;
+    if (s[i] == '+' || s[i] == '-') i++;
+    int base = 10;
+    if (i + 1 < s.size() && s[i] == '0') {
+        switch (s[i + 1]) {
+        case 'b':
+            base = 2, i += 2;
+            break;
+        case 'q':
+            base = 4, i += 2;
+            break;
+        case 'o':
+            base = 8, i += 2;
+            break;
+        case 'd':
+            i += 2;
+            break;
+        case 'x':
+            base = 16, i += 2;
+            break;
+        default:
+            break;
+        }
+    }
+    const size_t first = i;
+    while (i < s.size() && digit_of(s[i], base) >= 0) i++;
+    if (more && i >= s.size()) {
+        return cut(begin, offset);
+    }
+    if (i == first) {
+        return left(token_errors::bad_integer);
+    }
+    if (i - first > safe(base)) {
+        size_t used = 0;
+        if (primitive::integer_from<int>(s.substr(begin), used).is_left()) {
+            return left(token_errors::bad_integer);
+        }
+    }
+
+    if (i >= s.size() || s[i] != '.') {
+        offset = i;
+        return make(token_id::integer, begin, i);
+    }
+
+    // [0-9]+ was the integral part of a real
+    size_t stop = 0;
+    const size_t end = scan_real(s, begin, stop);
+    if (more && stop >= s.size()) {
+        return cut(begin, offset);
+    }
+    if (!end) {
+        return left(token_errors::bad_real);
+    }
+    if (primitive::real_from<float>(s.substr(begin, end - begin)).is_left()) {
+        return left(token_errors::bad_real);
+    }
+    offset = end;
+    return make(token_id::real, begin, end);
+}
+
+} // namespace
+
+either<compact_token, token_errors> span_lexer::next(std::string_view s, size_t &offset, bool more, bool operand,
+                                                     size_t *scanned) const {
+    const auto &lexers = token_parser::get_lexers();
+    size_t i = offset;
+    while (i < s.size() && lexers[static_cast<unsigned char>(s[i])] == lexer::space) i++;
+    offset = i;
+    if (i >= s.size()) {
+        return left(token_errors::end_of_input);
+    }
+
+    const size_t begin = i;
+    // past the bytes of a cut token at begin that an earlier call already scanned
+    const auto resume_at = [&](size_t first) { return scanned && *scanned > first + 1 ? *scanned : first + 1; };
+    switch (lexers[static_cast<unsigned char>(s[i])]) {
+    case lexer::sign:
+        // after an operand a sign is always a mark
+        if (!operand && i + 1 < s.size() && is_digit(s[i + 1])) {
+            return number(s, begin, offset, more);
+        }
+        if (!operand && more && i + 1 >= s.size()) {
+            return cut(begin, offset);
+        }
+        [[fallthrough]];
+    case lexer::mark: {
+        const auto mark = match_mark(s.substr(i));
+        if (!mark) {
+            return left(token_errors::bad_mark);
+        }
+        const auto [id, size] = *mark;
+        offset = i + size;
+        return make(id, begin, offset);
+    }
+    case lexer::number:
+        return number(s, begin, offset, more);
+    case lexer::identifier: {
+        const auto tail = [&](char c) {
+            const lexer l = lexers[static_cast<unsigned char>(c)];
+            return l == lexer::identifier || l == lexer::number;
+        };
+        for (i = resume_at(begin); i < s.size() && tail(s[i]); i++) {
+        }
+        if (more && i >= s.size()) {
+            if (scanned) *scanned = i;
+            return cut(begin, offset);
+        }
+        const std::string_view name = s.substr(begin, i - begin);
+        offset = i;
+        return make(name == "true" || name == "false" ? token_id::boolean : token_id::variable, begin, i);
+    }
+    case lexer::text: {
+        const char quote = s[i];
+        for (i = resume_at(begin); i < s.size() && s[i] != quote; i++) {
+            if (s[i] == '\\' && (++i >= s.size() || !primitive::escape_of(s[i]))) {
+                if (more && i >= s.size()) {
+                    if (scanned) *scanned = i - 1; // the escape is read again
+                    return cut(begin, offset);
+                }
+                return left(token_errors::bad_text);
+            }
+        }
+        if (i >= s.size()) {
+            if (more) {
+                if (scanned) *scanned = i;
+                return cut(begin, offset);
+            }
+            return left(token_errors::bad_text);
+        }
+        offset = i + 1;
+        return make(token_id::text, begin, offset);
+    }
+    case lexer::none:
+        return left(token_errors::unexpected_character);
+    default:
+        throw std::domain_error("lexer domain error");
+    }
+}
+
+either<lazy_tokens, std::string> span_lexer::tokenize(std::string_view source) const {
+    if (source.size() > UINT32_MAX) {
+        return left(std::string("source does not fit 32 bit offsets"));
+    }
+
+    lazy_tokens tokens(source, table);
+    bool operand = false;
+    for (size_t offset = 0;;) {
+        auto e = next(source, offset, false, operand);
+        if (e.is_right()) {
+            operand = ends_operand(e.get_right().id);
+            tokens.push_back(e.get_right());
+            continue;
+        }
+        if (e.get_left() == token_errors::end_of_input) {
+            return right(std::move(tokens));
+        }
+        return left(std::string(message_of(e.get_left())));
+    }
+}
+
+} // namespace tokenizes::tokens
@@ -0,0 +1,71 @@
+#pragma once
+#include "either.hpp"
+#include "symbols.hpp"
+#include "tokens.hpp"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace tokenizes::tokens {
+
+/** tokens over a source kept in memory, with values decoded on first access
+ * each token is a compact_token whose payload is unused; the source span holds the value.
+ * value() converts integers, reals and texts, and interns variables, only when asked.
+ * with caching on, decoded values are kept (not thread safe: share a lazy_tokens read-only with caching off).
+ */
+class lazy_tokens {
+    std::string_view source;
+    std::vector<compact_token> tokens;
+    std::shared_ptr<symbols::symbol_table> table;
+    bool caching{true};
+    mutable std::vector<value_t> cache;
+
+    value_t decode(const compact_token &t) const;
+
+public:
+    lazy_tokens(std::string_view _source, std::shared_ptr<symbols::symbol_table> _table)
+        : source(_source), table(std::move(_table)) {}
+
+    void push_back(const compact_token &t) { tokens.push_back(t); }
+    void reserve(size_t n) { tokens.reserve(n); }
+    void set_caching(bool _caching) { caching = _caching, cache.clear(); }
+
+    size_t size() const { return tokens.size(); }
+    bool empty() const { return tokens.empty(); }
+    const compact_token &operator[](size_t i) const { return tokens[i]; }
+    std::string_view text(size_t i) const { return source.substr(tokens[i].offset, tokens[i].length); }
+    value_t value(size_t i) const;
+    token at(size_t i) const;
+
+    std::span<const compact_token> get_tokens() const { return tokens; }
+    std::string_view get_source() const { return source; }
+    symbols::symbol_table &get_symbols() const { return *table; }
+};
+
+/** token_parser over a contiguous source
+ * tokens are validated as token_parser would (including integer overflow), but nothing is converted.
+ * the source must outlive the tokens.
+ */
+class span_lexer {
+    std::shared_ptr<symbols::symbol_table> table;
+
+public:
+    span_lexer() : table(std::make_shared<symbols::symbol_table>()) {}
+    span_lexer(std::shared_ptr<symbols::symbol_table> _table) : table(std::move(_table)) {}
+
+    /** next token at or after offset (leading spaces are skipped), offset is moved past it
+     * with more set, source is a prefix of the input: a token that may continue past its end
+     * is not lexed, and end_of_input is returned with offset left at its first byte.
+     * with operand set, the previous token ends an operand (see ends_operand), so a sign is a mark.
+     * scanned, when given, records how far a cut text or identifier was read; passed back with the same token
+     * at offset and more of the input appended, the scan resumes there instead of at the token's first byte.
+     */
+    either<compact_token, token_errors> next(std::string_view source, size_t &offset, bool more = false,
+                                             bool operand = false, size_t *scanned = nullptr) const;
+    either<lazy_tokens, std::string> tokenize(std::string_view source) const;
+    symbols::symbol_table &get_symbols() const { return *table; }
+};
+
+} // namespace tokenizes::tokens
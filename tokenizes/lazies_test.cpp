@@ -0,0 +1,175 @@
+#include "lazies.hpp"
+#include "primitive.hpp"
+#include "tokens.hpp"
+
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+
+using namespace tokenizes::tokens;
+
+namespace lazies_tests {
+
+// value of a token with variables compared by name, so separate symbol tables agree
+static std::string describe(const value_t &v, const tokenizes::symbols::symbol_table &table) {
+    std::stringstream ss;
+    if (const auto *s = std::get_if<symbol>(&v)) {
+        ss << "symbol:" << table.name(*s);
+    } else {
+        ss << v;
+    }
+    return ss.str();
+}
+
+TEST(span_lexer, same_as_token_parser) {
+    const std::string source = "x = -12 + 0x1F * (3.5e2 - y_1) / 'a\\nb' % \"q\" true false 0b101 +7 - 2.25 _z9";
+
+    token_parser parser;
+    std::stringstream ss(source);
+    const auto eager = parser.tokenize(ss);
+    ASSERT_TRUE(eager.is_right());
+
+    span_lexer lexer;
+    const auto lazy = lexer.tokenize(source);
+    ASSERT_TRUE(lazy.is_right());
+
+    const auto &expected = eager.get_right();
+    const auto &actual = lazy.get_right();
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        const token t = actual.at(i);
+        EXPECT_EQ(t.id, expected[i].id) << i;
+        EXPECT_EQ(t.pos.begin, expected[i].pos.begin) << i;
+        EXPECT_EQ(t.pos.end, expected[i].pos.end) << i;
+        EXPECT_EQ(describe(t.value, actual.get_symbols()), describe(expected[i].value, parser.get_symbols())) << i;
+    }
+}
+
+TEST(span_lexer, text) {
+    span_lexer lexer;
+    const std::string source = "abc  'x\\ty'";
+    const auto e = lexer.tokenize(source);
+    ASSERT_TRUE(e.is_right());
+    const auto &tokens = e.get_right();
+    ASSERT_EQ(tokens.size(), 2);
+    EXPECT_EQ(tokens.text(0), "abc");
+    EXPECT_EQ(tokens.text(1), "'x\\ty'");
+    EXPECT_EQ(tokens.value(1), value_t(text_t("x\ty")));
+}
+
+TEST(span_lexer, nothing_interned_until_read) {
+    span_lexer lexer;
+    const std::string source = "alpha beta";
+    const auto e = lexer.tokenize(source);
+    ASSERT_TRUE(e.is_right());
+    const auto &tokens = e.get_right();
+    EXPECT_FALSE(lexer.get_symbols().find("alpha").has_value());
+    tokens.value(0);
+    EXPECT_TRUE(lexer.get_symbols().find("alpha").has_value());
+    EXPECT_FALSE(lexer.get_symbols().find("beta").has_value());
+}
+
+TEST(span_lexer, caching) {
+    span_lexer lexer;
+    const std::string source = "'long enough to be decoded once'";
+    auto e = lexer.tokenize(source);
+    ASSERT_TRUE(e.is_right());
+    auto &tokens = e.get_right();
+    const value_t first = tokens.value(0);
+    EXPECT_EQ(tokens.value(0), first);
+
+    tokens.set_caching(false);
+    EXPECT_EQ(tokens.value(0), first);
+}
+
+TEST(span_lexer, errors) {
+    span_lexer lexer;
+    for (const auto &[source, error] : {
+             std::pair<std::string, token_errors>{"1 $", token_errors::unexpected_character},
+             {"99999999999", token_errors::bad_integer},
+             {"-2147483649", token_errors::bad_integer},
+             {"0x", token_errors::bad_integer},
+             {"1.", token_errors::bad_real},
+             {"1.5e", token_errors::bad_real},
+             {"1.0e99", token_errors::bad_real},
+             {"'open", token_errors::bad_text},
+             {"'\\q'", token_errors::bad_text},
+         }) {
+        std::stringstream ss(source);
+        const auto eager = token_parser().tokenize(ss);
+        const auto lazy = lexer.tokenize(source);
+        ASSERT_TRUE(lazy.is_left()) << source;
+        EXPECT_EQ(lazy.get_left(), message_of(error)) << source;
+        ASSERT_TRUE(eager.is_left()) << source;
+        EXPECT_EQ(lazy.get_left(), eager.get_left()) << source;
+    }
+}
+
+TEST(span_lexer, limits) {
+    span_lexer lexer;
+    const std::string source = "-2147483648 2147483647 0b1111111111111111111111111111111";
+    const auto e = lexer.tokenize(source);
+    ASSERT_TRUE(e.is_right());
+    const auto &tokens = e.get_right();
+    ASSERT_EQ(tokens.size(), 3);
+    EXPECT_EQ(tokens.value(0), value_t(-2147483647 - 1));
+    EXPECT_EQ(tokens.value(1), value_t(2147483647));
+    EXPECT_EQ(tokens.value(2), value_t(2147483647));
+}
+
+TEST(span_lexer, more) {
+    span_lexer lexer;
+    for (const std::string source : {"abc", "12", "0x", "1.", "1.5e", "'open", "'esc\\", "-"}) {
+        size_t offset = 0;
+        const auto cut = lexer.next(" " + source, offset, true);
+        ASSERT_TRUE(cut.is_left()) << source;
+        EXPECT_EQ(cut.get_left(), token_errors::end_of_input) << source;
+        EXPECT_EQ(offset, 1) << source;
+    }
+
+    size_t offset = 0;
+    const auto e = lexer.next("'done' x", offset, true);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().length, 6);
+}
+
+TEST(span_lexer, resumes_cut_tokens) {
+    span_lexer lexer;
+    size_t offset = 0, scanned = 0;
+    EXPECT_TRUE(lexer.next("'abc", offset, true, false, &scanned).is_left());
+    EXPECT_EQ(scanned, 4);
+    EXPECT_TRUE(lexer.next("'abc\\", offset, true, false, &scanned).is_left());
+    EXPECT_EQ(scanned, 4); // the cut escape is read again
+    scanned = 0;
+    EXPECT_TRUE(lexer.next("abc", offset, true, false, &scanned).is_left());
+    EXPECT_EQ(scanned, 3);
+
+    // bytes before scanned are taken as read: the bad escape is not seen again
+    scanned = 4;
+    const auto e = lexer.next("'a\\qc' x", offset, true, false, &scanned);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().length, 6);
+}
+
+TEST(integer_from, overflow) {
+    size_t used = 0;
+    const auto over = tokenizes::primitive::integer_from<int>("99999999999", used);
+    ASSERT_TRUE(over.is_left());
+    EXPECT_EQ(over.get_left(), tokenizes::primitive::integer_errors::overflow);
+
+    const auto under = tokenizes::primitive::integer_from<int>("-2147483649", used);
+    ASSERT_TRUE(under.is_left());
+    EXPECT_EQ(under.get_left(), tokenizes::primitive::integer_errors::underflow);
+
+    const auto e = tokenizes::primitive::integer_from<int>("0x7fffffff;", used);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right(), 0x7fffffff);
+    EXPECT_EQ(used, 10);
+
+    std::stringstream ss("99999999999");
+    const auto parsed = tokenizes::primitive::integer_parser<int>()(ss);
+    ASSERT_TRUE(parsed.is_left());
+    EXPECT_EQ(parsed.get_left(), tokenizes::primitive::integer_errors::overflow);
+}
+
+} // namespace lazies_tests
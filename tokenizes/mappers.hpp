@@ -1,6 +1,11 @@
 #pragma once
 #include "concepts.hpp"
+#include "contexts.hpp"
 #include "either.hpp"
+#include "firsts.hpp"
+#include "inputs.hpp"
+#include "primitive.hpp"
+#include "probes.hpp"
 #include <cassert>
 #include <concepts>
 #include <cstddef>
@@ -9,10 +14,12 @@
 #include <ios>
 #include <istream>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 namespace tokenizes::mappers {
 
 using tokenizes::concepts::either_of;
+using tokenizes::concepts::input_of;
 using tokenizes::concepts::left_of;
 using tokenizes::concepts::parsable;
 using tokenizes::concepts::right_of;
@@ -23,6 +30,10 @@ using tokenizes::eithers::right;
 
 template <parsable P, std::invocable<right_of<P>> M>
 class mapper_right {
+public:
+    using input_t = input_of<P>;
+
+private:
     using right_t = std::invoke_result_t<M, right_of<P>>;
     using left_t = left_of<P>;
 
@@ -37,7 +48,7 @@ public:
     mapper_right(P &&_parser, M &&_map)
         requires std::move_constructible<P> && std::move_constructible<M>
         : parser(_parser), map(_map) {}
-    either<right_t, left_t> operator()(std::istream &is) const {
+    either<right_t, left_t> operator()(input_t &is) const {
         either_of<P> result = parser(is);
         switch (result.get_mode()) {
         case either_mode::right:
@@ -50,10 +61,15 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
 template <parsable P, std::invocable<left_of<P>> M>
 class mapper_left {
+public:
+    using input_t = input_of<P>;
+
+private:
     using right_t = right_of<P>;
     using left_t = std::invoke_result_t<M, left_of<P>>;
 
@@ -69,7 +85,7 @@ public:
         requires std::move_constructible<P> && std::move_constructible<M>
         : parser(_parser), map(_map) {}
 
-    either<right_t, left_t> operator()(std::istream &is) const {
+    either<right_t, left_t> operator()(input_t &is) const {
         either_of<P> result = parser(is);
         switch (result.get_mode()) {
         case either_mode::right:
@@ -82,11 +98,14 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
 template <parsable P, class V>
     requires std::move_constructible<V> && std::copy_constructible<V>
 class constant_right {
+public:
+    using input_t = input_of<P>;
 
 private:
     P parser;
@@ -100,7 +119,7 @@ public:
         requires std::move_constructible<P> && std::move_constructible<V>
         : parser(_parser), value(_value) {}
 
-    either<V, left_of<P>> operator()(std::istream &is) const {
+    either<V, left_of<P>> operator()(input_t &is) const {
         either_of<P> result = parser(is);
         switch (result.get_mode()) {
         case either_mode::right:
@@ -113,11 +132,14 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
 template <parsable P, class V>
     requires std::move_constructible<V> && std::copy_constructible<V>
 class constant_left {
+public:
+    using input_t = input_of<P>;
 
 private:
     P parser;
@@ -131,7 +153,7 @@ public:
         requires std::move_constructible<P> && std::move_constructible<V>
         : parser(_parser), value(_value) {}
 
-    either<right_of<P>, V> operator()(std::istream &is) const {
+    either<right_of<P>, V> operator()(input_t &is) const {
         either_of<P> result = parser(is);
         switch (result.get_mode()) {
         case either_mode::right:
@@ -144,10 +166,15 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
 template <parsable P>
 class eraser_right {
+public:
+    using input_t = input_of<P>;
+
+private:
     P parser;
 
 public:
@@ -157,7 +184,7 @@ public:
     eraser_right(P &&_parser)
         requires std::move_constructible<P>
         : parser(_parser) {}
-    either<std::nullptr_t, left_of<P>> operator()(std::istream &is) const {
+    either<std::nullptr_t, left_of<P>> operator()(input_t &is) const {
         either_of<P> result = parser(is);
         switch (result.get_mode()) {
         case either_mode::right:
@@ -170,10 +197,15 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
 template <parsable P>
 class eraser_left {
+public:
+    using input_t = input_of<P>;
+
+private:
     P parser;
 
 public:
@@ -183,7 +215,7 @@ public:
     eraser_left(P &&_parser)
         requires std::move_constructible<P>
         : parser(_parser) {}
-    either<right_of<P>, std::nullptr_t> operator()(std::istream &is) const {
+    either<right_of<P>, std::nullptr_t> operator()(input_t &is) const {
         either_of<P> result = parser(is);
         switch (result.get_mode()) {
         case either_mode::right:
@@ -196,10 +228,15 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
 template <parsable P>
 class eraser_both {
+public:
+    using input_t = input_of<P>;
+
+private:
     P parser;
 
 public:
@@ -209,7 +246,7 @@ public:
     eraser_both(P &&_parser)
         requires std::move_constructible<P>
         : parser(_parser) {}
-    either<std::nullptr_t, std::nullptr_t> operator()(std::istream &is) const {
+    either<std::nullptr_t, std::nullptr_t> operator()(input_t &is) const {
         either_of<P> result = parser(is);
         switch (result.get_mode()) {
         case either_mode::right:
@@ -222,9 +259,13 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
-template <parsable P>
+/** the input consumed by a parser, as a string
+ * S = std::pmr::string allocates it from the input's resource (see contexts::resource_scope).
+ */
+template <parsable P, class S = std::string>
 class recognition {
     P parser;
 
@@ -235,14 +276,14 @@ public:
     recognition(P &&_parser)
         requires std::move_constructible<P>
         : parser(_parser) {}
-    either<std::string, left_of<P>> operator()(std::istream &is) const {
+    either<S, left_of<P>> operator()(std::istream &is) const {
         const std::streampos begin = is.tellg();
         either_of<P> result = parser(is);
         const std::streampos end = is.tellg();
 
         switch (result.get_mode()) {
         case either_mode::right: {
-            std::string buffer;
+            S buffer = contexts::make_result<S>(is);
             buffer.reserve(end - begin);
 
             is.seekg(begin);
@@ -250,7 +291,7 @@ public:
                 buffer.push_back(is.get());
             }
 
-            return right<std::string>(buffer);
+            return right<S>(std::move(buffer));
         }
         case either_mode::left:
             return result.into_left();
@@ -260,8 +301,14 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
+template <parsable P>
+static inline auto pmr_recognition(const P &p) {
+    return recognition<P, std::pmr::string>(p);
+}
+
 template <class T>
 class tag_mapper {
 
@@ -283,7 +330,13 @@ public:
         }
 
         std::optional<T> find(std::istream &is) const {
-            const int index = is.get();
+            return find(is, [](std::streampos) {});
+        }
+
+        // rewinding is told each position the longest match seeks back to
+        template <class F>
+        std::optional<T> find(std::istream &is, F &&rewinding) const {
+            const int index = is.peek();
 
             if (index == -1) {
                 return value;
@@ -293,15 +346,28 @@ public:
             if (table[index]) {
                 const node &next_node = *table[index];
                 const std::streampos pos = is.tellg();
-                if (const std::optional<T> next_value = next_node.find(is); next_value) {
+                is.ignore();
+                if (const std::optional<T> next_value = next_node.find(is, rewinding); next_value) {
                     return next_value;
                 }
+                rewinding(pos);
                 is.seekg(pos);
             }
 
             return value;
         }
 
+        firsts::first_set first() const {
+            if (value) {
+                return firsts::any();
+            }
+            firsts::first_set chars;
+            for (size_t i = 0; i < table.size(); i++) {
+                chars.set(i, table[i] != nullptr);
+            }
+            return chars;
+        }
+
         void insert(std::string_view key, const T &value) {
             if (key.size() == 0) {
                 this->value = value; // terminal
@@ -323,24 +389,29 @@ public:
     };
 
 private:
-    mutable std::shared_ptr<node> root;
+    // built once, then only read: copies share it and parsing never touches the reference count
+    std::shared_ptr<const node> root;
+    [[no_unique_address]] probes::probe probe{"tag_mapper"};
 
 public:
     template <std::ranges::input_range R>
         requires std::convertible_to<std::ranges::range_value_t<R>, std::tuple<std::string_view, T>>
     tag_mapper(R &&r) : root(std::make_shared<node>(r)) {}
     tag_mapper(std::initializer_list<std::tuple<std::string_view, T>> &&list) : root(std::make_shared<node>(list)) { ; }
-    tag_mapper(const tag_mapper &tm) : root(tm.root) {}
+    tag_mapper(const tag_mapper &tm) = default;
     either<T, std::nullptr_t> operator()(std::istream &is) const {
-        if (const std::optional<T> opt = root->find(is); opt) {
+        probes::scope<probes::probe, std::istream> call(probe, is);
+        if (const std::optional<T> opt = root->find(is, [&call](std::streampos pos) { call.rewinding(pos); }); opt) {
+            call.succeeded();
             return right(*opt);
         }
         return left(nullptr);
     }
+    firsts::first_set first() const { return root->first(); }
 };
 
 struct position {
-    const size_t begin, end;
+    size_t begin, end;
     constexpr position(size_t _begin, size_t _end) : begin(_begin), end(_end) {}
     constexpr size_t size() const { return end - begin; }
 };
@@ -350,6 +421,7 @@ std::ostream &operator<<(std::ostream &os, const position &p);
 template <parsable P>
 class positioned {
 public:
+    using input_t = input_of<P>;
     using right_t = std::tuple<position, right_of<P>>;
     using left_t = left_of<P>;
 
@@ -363,13 +435,13 @@ public:
     constexpr positioned(P &&_parser)
         requires std::move_constructible<P>
         : parser(std::move(_parser)) {}
-    either<right_t, left_t> operator()(std::istream &is) const {
-        const std::streampos begin = is.tellg();
+    either<right_t, left_t> operator()(input_t &is) const {
+        const auto begin = inputs::tell(is);
         either<right_of<P>, left_of<P>> result = parser(is);
 
         switch (result.get_mode()) {
         case either_mode::right: {
-            const std::streampos end = is.tellg();
+            const auto end = inputs::tell(is);
 
             return right(std::tuple<position, right_of<P>>(position(begin, end), result.get_right()));
         }
@@ -382,6 +454,7 @@ public:
             throw std::domain_error("mode domain error");
         }
     }
+    firsts::first_set first() const { return firsts::first_of(parser); }
 };
 
 } // namespace tokenizes::mappers
@@ -169,6 +169,13 @@ TEST(tag_mapper_tests, zero) {
     EXPECT_EQ(parser(ss).opt_right(), std::nullopt);
 }
 
+TEST(tag_mapper_tests, rest) {
+    std::stringstream ss;
+    ss << "one+";
+    EXPECT_EQ(parser(ss).opt_right(), 1);
+    EXPECT_EQ(ss.peek(), '+');
+}
+
 TEST(tag_mapper_tests, clone) {
     const static auto clone = parser;
     std::stringstream ss;
@@ -0,0 +1,49 @@
+#include "memos.hpp"
+#include <ios>
+namespace tokenizes::memos {
+
+std::ostream &operator<<(std::ostream &os, const memo_stats &s) {
+    return os << "memo: {hits: " << s.hits << ", misses: " << s.misses << ", evictions: " << s.evictions
+              << ", expirations: " << s.expirations << ", hit_rate: " << s.hit_rate() << "}";
+}
+
+static int state_index() {
+    static const int index = std::ios_base::xalloc();
+    return index;
+}
+
+static void state_event(std::ios_base::event event, std::ios_base &ios, int index) {
+    void *&p = ios.pword(index);
+    switch (event) {
+    case std::ios_base::erase_event:
+        delete static_cast<memo_state *>(p);
+        p = nullptr;
+        break;
+    case std::ios_base::copyfmt_event:
+        // copyfmt shares the pointer, the copy starts without results
+        p = p ? new memo_state() : nullptr;
+        break;
+    default:
+        break;
+    }
+}
+
+memo_state &state_of(std::istream &is) {
+    void *&p = is.pword(state_index());
+    if (!p) {
+        p = new memo_state();
+        is.register_callback(state_event, state_index());
+    }
+    memo_state &state = *static_cast<memo_state *>(p);
+    if (state.buffer != is.rdbuf()) {
+        state.tables.clear();
+        state.buffer = is.rdbuf();
+    }
+    return state;
+}
+
+void forget(std::istream &is) {
+    state_of(is).tables.clear();
+}
+
+} // namespace tokenizes::memos
\ No newline at end of file
@@ -0,0 +1,176 @@
+#pragma once
+#include "concepts.hpp"
+#include "either.hpp"
+#include "firsts.hpp"
+#include "inputs.hpp"
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <unordered_map>
+#include <vector>
+namespace tokenizes::memos {
+
+using tokenizes::concepts::either_of;
+using tokenizes::concepts::input_of;
+using tokenizes::concepts::parsable;
+
+struct memo_stats {
+    size_t hits{0}, misses{0}, evictions{0}, expirations{0};
+    double hit_rate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+};
+
+std::ostream &operator<<(std::ostream &os, const memo_stats &s);
+
+// tables of different result types, held by memo_state
+class memo_base {
+public:
+    virtual ~memo_base() = default;
+};
+
+/** packrat table: (parser-id, offset) -> result + end offset
+ * slots are direct-mapped, so a colliding store evicts the previous entry.
+ * entries more than window bytes behind the furthest offset seen are expired, which bounds streaming inputs.
+ * a table belongs to one stream (see memo_state), so it is only ever used by one parse at a time.
+ */
+template <class E>
+class memo_table : public memo_base {
+    struct slot {
+        uint32_t id{0};
+        bool used{false};
+        std::streamoff offset{0}, end{0};
+        E result;
+    };
+
+    std::vector<slot> slots;
+    size_t window;
+    std::streamoff furthest{0};
+    memo_stats stats;
+
+    size_t index(uint32_t id, std::streamoff offset) const {
+        const uint64_t h = (static_cast<uint64_t>(offset) ^ (static_cast<uint64_t>(id) << 40)) * 0x9e3779b97f4a7c15;
+        return (h >> 32) & (slots.size() - 1);
+    }
+
+public:
+    memo_table(size_t capacity = 4096, size_t _window = SIZE_MAX)
+        : slots(std::bit_ceil(std::max<size_t>(capacity, 1))), window(_window) {}
+
+    // hit: result and end offset
+    const slot *find(uint32_t id, std::streamoff offset) {
+        furthest = std::max(furthest, offset);
+
+        slot &s = slots[index(id, offset)];
+        if (!s.used || s.id != id || s.offset != offset) {
+            stats.misses++;
+            return nullptr;
+        }
+        if (static_cast<size_t>(furthest - s.offset) > window) {
+            s.used = false, s.result.reset();
+            stats.expirations++, stats.misses++;
+            return nullptr;
+        }
+        stats.hits++;
+        return &s;
+    }
+
+    void store(uint32_t id, std::streamoff offset, std::streamoff end, const E &result) {
+        slot &s = slots[index(id, offset)];
+        if (s.used && (s.id != id || s.offset != offset)) {
+            stats.evictions++;
+        }
+        s.id = id, s.used = true, s.offset = offset, s.end = end;
+        s.result = result;
+    }
+
+    void clear() {
+        for (slot &s : slots) {
+            s.used = false, s.result.reset();
+        }
+        furthest = 0;
+    }
+
+    const memo_stats &get_stats() const { return stats; }
+    void reset_stats() { stats = memo_stats(); }
+    size_t capacity() const { return slots.size(); }
+};
+
+/** memo tables of one stream, by memoize id, attached through pword
+ * only the memoize parsers that ran on the stream have a table, however many were ever built.
+ * results are only valid for the bytes they were parsed from: the tables are dropped
+ * when the stream reads through another buffer, and forget drops them explicitly.
+ */
+struct memo_state {
+    const std::streambuf *buffer{nullptr};
+    std::unordered_map<uint32_t, std::unique_ptr<memo_base>> tables;
+};
+
+memo_state &state_of(std::istream &is);
+
+// drops every memoized result of is, e.g. once its buffer was refilled with another text (str, seekg to reuse)
+void forget(std::istream &is);
+
+static inline uint32_t next_memo_id() {
+    static std::atomic<uint32_t> id{0};
+    return id.fetch_add(1, std::memory_order_relaxed);
+}
+
+/** packrat memoization of a parser
+ * the parser itself is immutable, the results live with the stream being parsed (memo_state),
+ * so one instance may parse any number of streams, from any number of threads.
+ * inputs other than std::istream are parsed without memoization.
+ */
+template <parsable P>
+class memoize {
+public:
+    using input_t = input_of<P>;
+    using either_t = either_of<P>;
+    using right_t = typename either_t::right_t;
+    using left_t = typename either_t::left_t;
+    using table_t = memo_table<either_t>;
+
+private:
+    P parser;
+    uint32_t id;
+    size_t capacity, window;
+
+    table_t &table_of(std::istream &is) const {
+        std::unique_ptr<memo_base> &table = state_of(is).tables[id];
+        if (!table) {
+            table = std::make_unique<table_t>(capacity, window);
+        }
+        return static_cast<table_t &>(*table);
+    }
+
+public:
+    memoize(const P &_parser, size_t _capacity = 4096, size_t _window = SIZE_MAX)
+        : parser(_parser), id(next_memo_id()), capacity(_capacity), window(_window) {}
+
+    either_t operator()(input_t &is) const {
+        if constexpr (!std::derived_from<input_t, std::istream>) {
+            return parser(is);
+        } else {
+            using position_t = inputs::position_of<input_t>;
+            table_t &table = table_of(is);
+            const std::streamoff begin = inputs::tell(is);
+            if (const auto *hit = table.find(id, begin); hit) {
+                inputs::rewind(is, static_cast<position_t>(hit->end));
+                return hit->result;
+            }
+
+            either_t result = parser(is);
+            table.store(id, begin, inputs::tell(is), result);
+            return result;
+        }
+    }
+
+    firsts::first_set first() const { return firsts::first_of(parser); }
+    // statistics of the results memoized for is
+    memo_stats get_stats(std::istream &is) const { return table_of(is).get_stats(); }
+};
+
+} // namespace tokenizes::memos
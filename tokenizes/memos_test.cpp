@@ -0,0 +1,151 @@
+#include "combinators.hpp"
+#include "memos.hpp"
+#include "primitive.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace tokenizes::memos;
+using tokenizes::combinators::branch;
+using tokenizes::combinators::sequencer;
+using tokenizes::eithers::either;
+using tokenizes::primitive::atom;
+using tokenizes::primitive::digit;
+
+namespace memoize_tests {
+
+struct counted {
+    int *calls;
+    either<char, std::nullptr_t> operator()(std::istream &is) const { return ++*calls, digit(is); }
+};
+
+TEST(memoize, hit) {
+    int calls = 0;
+    const auto parser = memoize(counted{&calls});
+    std::stringstream ss;
+    ss << "1";
+    EXPECT_EQ(parser(ss).opt_right(), '1');
+    ss.seekg(0);
+    EXPECT_EQ(parser(ss).opt_right(), '1');
+    EXPECT_EQ(ss.tellg(), 1);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(parser.get_stats(ss).hits, 1);
+    EXPECT_EQ(parser.get_stats(ss).misses, 1);
+}
+
+TEST(memoize, failure) {
+    int calls = 0;
+    const auto parser = memoize(counted{&calls});
+    std::stringstream ss;
+    ss << "x";
+    EXPECT_TRUE(parser(ss).is_left());
+    EXPECT_TRUE(parser(ss).is_left());
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(memoize, branch) {
+    int calls = 0;
+    const auto shared = memoize(counted{&calls});
+    const auto parser = branch(sequencer(shared, atom('a')), sequencer(shared, atom('b')));
+    std::stringstream ss;
+    ss << "1b";
+    EXPECT_EQ(parser(ss).opt_right(), "1b");
+    EXPECT_EQ(calls, 1);
+    EXPECT_DOUBLE_EQ(shared.get_stats(ss).hit_rate(), 0.5);
+}
+
+TEST(memoize, window) {
+    int calls = 0;
+    const auto parser = memoize(counted{&calls}, 16, 1);
+    std::stringstream ss;
+    ss << "123";
+    parser(ss), parser(ss), parser(ss);
+    ss.seekg(0);
+    parser(ss);
+    EXPECT_EQ(calls, 4);
+    EXPECT_EQ(parser.get_stats(ss).expirations, 1);
+}
+
+TEST(memoize, eviction) {
+    int calls = 0;
+    const auto parser = memoize(counted{&calls}, 1);
+    std::stringstream ss;
+    ss << "12";
+    parser(ss), parser(ss);
+    EXPECT_EQ(parser.get_stats(ss).evictions, 1);
+}
+
+TEST(memoize, other_stream) {
+    int calls = 0;
+    const auto parser = memoize(counted{&calls});
+    std::stringstream x, y;
+    x << "1";
+    y << "x";
+    EXPECT_TRUE(parser(x).is_right());
+    EXPECT_TRUE(parser(y).is_left());
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(memoize, new_stream_at_same_address) {
+    const auto parser = memoize(digit);
+    std::optional<std::stringstream> ss;
+    ss.emplace("1");
+    EXPECT_EQ(parser(*ss).opt_right(), '1');
+    const void *first = &*ss;
+    ss.emplace("2");
+    ASSERT_EQ(&*ss, first);
+    EXPECT_EQ(parser(*ss).opt_right(), '2');
+}
+
+TEST(memoize, forget) {
+    int calls = 0;
+    const auto parser = memoize(counted{&calls});
+    std::stringstream ss("1");
+    EXPECT_EQ(parser(ss).opt_right(), '1');
+    ss.clear(), ss.str("2");
+    forget(ss);
+    EXPECT_EQ(parser(ss).opt_right(), '2');
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(memoize, other_buffer) {
+    const auto parser = memoize(digit);
+    std::stringbuf one("1"), two("2");
+    std::istream is(&one);
+    EXPECT_EQ(parser(is).opt_right(), '1');
+    is.rdbuf(&two);
+    EXPECT_EQ(parser(is).opt_right(), '2');
+}
+
+TEST(memoize, tables_of_used_parsers) {
+    std::stringstream ss("12");
+    for (int i = 0; i < 1000; i++) {
+        memoize(digit, 16);
+    }
+    const auto parser = memoize(digit, 16);
+    EXPECT_EQ(parser(ss).opt_right(), '1');
+    const auto copy = parser;
+    EXPECT_EQ(copy(ss).opt_right(), '2');
+    EXPECT_EQ(state_of(ss).tables.size(), 1);
+}
+
+TEST(memoize, shared_between_threads) {
+    const auto parser = memoize(digit);
+    std::vector<std::thread> threads;
+    std::atomic<int> wrong{0};
+    for (char c = '0'; c <= '9'; c++) {
+        threads.emplace_back([&parser, &wrong, c]() {
+            for (int k = 0; k < 1000; k++) {
+                std::stringstream ss(std::string(1, c));
+                if (parser(ss).opt_right() != c || parser.get_stats(ss).misses != 1) wrong++;
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+    EXPECT_EQ(wrong, 0);
+}
+
+} // namespace memoize_tests
@@ -17,6 +17,7 @@
 #include "combinators.hpp"
 #include "concepts.hpp"
 #include "either.hpp"
+#include "firsts.hpp"
 #include "mappers.hpp"
 #include "primitive.hpp"
 #include "repeats.hpp"
@@ -38,14 +39,24 @@ public:
     using right_t = R;
     using left_t = L;
     using parser_t = std::function<either<R, L>(std::istream &)>;
+    // the closure may hold a cut, which branch, choice and repeat cannot see through
+    constexpr static bool cuts = true;
 
 private:
-    parser_t parser;
+    firsts::first_set first_chars{firsts::any()};
+    // immutable once built: copying a shell shares the closure instead of cloning it
+    std::shared_ptr<const parser_t> parser;
 
 public:
-    shell(const parser_t &_parser) : parser(_parser) {}
-    shell(parser_t &&_parser) : parser(std::move(_parser)) {}
-    either<R, L> operator()(std::istream &is) const { return parser(is); }
+    shell(const parser_t &_parser) : parser(std::make_shared<const parser_t>(_parser)) {}
+    shell(parser_t &&_parser) : parser(std::make_shared<const parser_t>(std::move(_parser))) {}
+    template <class P>
+        requires(!std::same_as<std::remove_cvref_t<P>, shell>) && (!std::same_as<std::remove_cvref_t<P>, parser_t>) &&
+                std::is_invocable_r_v<either<R, L>, const P &, std::istream &>
+    shell(P &&_parser)
+        : first_chars(firsts::first_of(_parser)), parser(std::make_shared<const parser_t>(std::forward<P>(_parser))) {}
+    either<R, L> operator()(std::istream &is) const { return (*parser)(is); }
+    firsts::first_set first() const { return first_chars; }
 
     // map_*
     template <class F>
@@ -70,14 +81,14 @@ public:
     }
 
     // repeat, many
-    auto repeat(size_t n, size_t m) const { return shell(repeats::repeat(*this, n, m)); }
-    auto many0() const { return shell(repeats::many0(*this)); }
-    auto many1() const { return shell(repeats::many1(*this)); }
+    auto repeat(size_t n, size_t m) const { return tokenizes::shell(repeats::repeat(*this, n, m)); }
+    auto many0() const { return tokenizes::shell(repeats::many0(*this)); }
+    auto many1() const { return tokenizes::shell(repeats::many1(*this)); }
 
     // erase_*
-    auto erase_right() const { return shell(eraser_right(*this)); }
-    auto erase_left() const { return shell(eraser_left(*this)); }
-    auto erase_both() const { return shell(eraser_both(*this)); }
+    auto erase_right() const { return tokenizes::shell(mappers::eraser_right(*this)); }
+    auto erase_left() const { return tokenizes::shell(mappers::eraser_left(*this)); }
+    auto erase_both() const { return tokenizes::shell(mappers::eraser_both(*this)); }
 
     // positioned
     auto positioned() const { return shell<std::tuple<position, R>, L>(mappers::positioned(*this)); };
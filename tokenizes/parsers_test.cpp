@@ -66,3 +66,18 @@ TEST(shell, tag_mapper_two) {
 
 }; // namespace constant_tests
 
+
+
+namespace first_tests {
+
+TEST(shell, first) {
+    const auto parser = shell(combinators::branch(tag("ab"), tag("cd"))).map_right([](const std::string &s) { return s.size(); });
+    EXPECT_EQ(parser.first(), tokenizes::primitive::atom("ac").get_chars());
+}
+
+TEST(shell, first_nullable) {
+    const auto parser = digit.many0();
+    EXPECT_TRUE(parser.first().all());
+}
+
+}; // namespace first_tests
@@ -0,0 +1,102 @@
+#include "perfs.hpp"
+#include <algorithm>
+#include <chrono>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+namespace tokenizes::perfs {
+
+std::string_view name_of(perf_event event) {
+    switch (event) {
+    case perf_event::cycles:
+        return "cycles";
+    case perf_event::instructions:
+        return "instructions";
+    case perf_event::branch_misses:
+        return "branch-misses";
+    case perf_event::cache_misses:
+        return "cache-misses";
+    default:
+        return "unknown";
+    }
+}
+
+std::optional<double> perf_sample::ipc() const {
+    const auto &cycles = (*this)[perf_event::cycles], &instructions = (*this)[perf_event::instructions];
+    if (!cycles || !instructions || *cycles == 0) return std::nullopt;
+    return static_cast<double>(*instructions) / *cycles;
+}
+
+perf_sample perf_sample::operator-(const perf_sample &x) const {
+    perf_sample d;
+    for (size_t i = 0; i < event_count; i++) {
+        if (counts[i] && x.counts[i]) d.counts[i] = *counts[i] - *x.counts[i];
+    }
+    d.seconds = seconds - x.seconds;
+    return d;
+}
+
+namespace {
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(__linux__)
+int open_event(perf_event event) {
+    constexpr static uint64_t configs[event_count]{PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                   PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[static_cast<size_t>(event)];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1; // pipeline threads are counted once joined
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+} // namespace
+
+perf_counters::perf_counters() {
+    fds.fill(-1);
+#if defined(__linux__)
+    for (size_t i = 0; i < event_count; i++) {
+        fds[i] = std::max(open_event(static_cast<perf_event>(i)), -1);
+    }
+#endif
+}
+
+perf_counters::~perf_counters() {
+#if defined(__linux__)
+    for (const int fd : fds) {
+        if (fd >= 0) close(fd);
+    }
+#endif
+}
+
+bool perf_counters::any() const {
+    return std::any_of(fds.begin(), fds.end(), [](int fd) { return fd >= 0; });
+}
+
+perf_sample perf_counters::sample() const {
+    perf_sample s;
+    s.seconds = now();
+#if defined(__linux__)
+    for (size_t i = 0; i < event_count; i++) {
+        uint64_t values[3]; // value, time enabled, time running
+        if (fds[i] < 0 || ::read(fds[i], values, sizeof(values)) != sizeof(values)) continue;
+        // multiplexed: extrapolate to the whole time enabled
+        s.counts[i] = values[2] == 0 || values[2] == values[1]
+                          ? values[0]
+                          : static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+    }
+#endif
+    return s;
+}
+
+} // namespace tokenizes::perfs
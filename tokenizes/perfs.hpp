@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+namespace tokenizes::perfs {
+
+enum class perf_event : uint8_t { cycles, instructions, branch_misses, cache_misses };
+constexpr static inline size_t event_count = 4;
+
+std::string_view name_of(perf_event event);
+
+// counts since the counters were opened, and wall time; events the kernel refused are empty
+struct perf_sample {
+    std::array<std::optional<uint64_t>, event_count> counts{};
+    double seconds{0};
+
+    const std::optional<uint64_t> &operator[](perf_event event) const { return counts[static_cast<size_t>(event)]; }
+    // instructions per cycle, when both are counted
+    std::optional<double> ipc() const;
+    perf_sample operator-(const perf_sample &x) const;
+};
+
+/** hardware counters of the calling thread (and threads it starts afterwards), through perf_event_open
+ * each event is opened on its own, so a machine without, say, cache-miss events still counts the rest;
+ * without perf events at all (not Linux, perf_event_paranoid, containers) only wall time is measured.
+ * counts are scaled when the kernel multiplexes the events.
+ */
+class perf_counters {
+    std::array<int, event_count> fds;
+
+public:
+    perf_counters();
+    perf_counters(const perf_counters &) = delete;
+    perf_counters &operator=(const perf_counters &) = delete;
+    ~perf_counters();
+
+    bool available(perf_event event) const { return fds[static_cast<size_t>(event)] >= 0; }
+    // whether any event is counted
+    bool any() const;
+    perf_sample sample() const;
+};
+
+} // namespace tokenizes::perfs
@@ -0,0 +1,71 @@
+#include "harnesses.hpp"
+#include "perfs.hpp"
+
+#include "gtest/gtest.h"
+#include <sstream>
+
+using namespace tokenizes::perfs;
+
+namespace perfs_tests {
+
+// sums that the optimizer cannot drop
+uint64_t work(uint64_t n) {
+    volatile uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        sum = sum + i * i;
+    }
+    return sum;
+}
+
+TEST(perf_counters, counts_or_falls_back) {
+    const perf_counters counters;
+    const perf_sample start = counters.sample();
+    work(1 << 20);
+    const perf_sample used = counters.sample() - start;
+
+    EXPECT_GT(used.seconds, 0);
+    for (size_t i = 0; i < event_count; i++) {
+        const auto event = static_cast<perf_event>(i);
+        // an event is read exactly when it could be opened
+        EXPECT_EQ(used[event].has_value(), counters.available(event)) << name_of(event);
+    }
+    if (counters.available(perf_event::instructions)) {
+        EXPECT_GT(*used[perf_event::instructions], 1u << 20);
+    }
+    EXPECT_EQ(used.ipc().has_value(), counters.available(perf_event::cycles) && counters.available(perf_event::instructions));
+}
+
+TEST(perf_sample, difference_and_ipc) {
+    perf_sample a, b;
+    a.counts = {1000, 3000, std::nullopt, 7};
+    b.counts = {400, 1800, 5, std::nullopt};
+    a.seconds = 2, b.seconds = 0.5;
+
+    const perf_sample d = a - b;
+    EXPECT_EQ(d[perf_event::cycles], 600u);
+    EXPECT_EQ(d[perf_event::instructions], 1200u);
+    EXPECT_FALSE(d[perf_event::branch_misses]);
+    EXPECT_FALSE(d[perf_event::cache_misses]);
+    EXPECT_DOUBLE_EQ(d.seconds, 1.5);
+    EXPECT_DOUBLE_EQ(*d.ipc(), 2.0);
+    EXPECT_FALSE(perf_sample().ipc());
+}
+
+TEST(perf_sample, kept_in_baselines) {
+    tokenizes::harnesses::harness_report report;
+    auto &r = report.engines["span"];
+    r.bytes = 100, r.tokens = 10, r.seconds = 1;
+    r.perf.counts = {500, 1000, std::nullopt, 3};
+
+    std::stringstream ss;
+    write_json(ss, report);
+    EXPECT_EQ(ss.str().find("branch_misses"), std::string::npos);
+    const auto read = tokenizes::harnesses::read_json(ss);
+    ASSERT_TRUE(read.is_right()) << read.get_left();
+    const perf_sample &perf = read.get_right().engines.at("span").perf;
+    EXPECT_EQ(perf[perf_event::cycles], 500u);
+    EXPECT_EQ(perf[perf_event::cache_misses], 3u);
+    EXPECT_FALSE(perf[perf_event::branch_misses]);
+}
+
+} // namespace perfs_tests
@@ -0,0 +1,136 @@
+#include "pipelines.hpp"
+#include <chrono>
+#include <exception>
+namespace tokenizes::pipelines {
+
+using eithers::left;
+using eithers::right;
+using tokens::token_errors;
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+either<pipeline_stats, std::string> token_pipeline::run(std::istream &source, const consumer &consume) const {
+    spsc_ring<std::string> blocks(options.queue_capacity);
+    spsc_ring<token_chunk> chunks(options.queue_capacity);
+    pipeline_stats stats;
+    std::string read_error, lex_error;
+
+    std::thread reader([&]() {
+        stage_stats &s = stats.reader;
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            std::string raw(std::max<size_t>(options.block_size, 1), '\0');
+            for (bool more = true; more;) {
+                source.read(raw.data(), static_cast<std::streamsize>(raw.size()));
+                const size_t n = static_cast<size_t>(source.gcount());
+                more = n == raw.size();
+                if (n == 0) break;
+
+                std::string block;
+                if (options.decoder) {
+                    options.decoder(std::string_view(raw.data(), n), block);
+                } else {
+                    block.assign(raw.data(), n);
+                }
+                s.items++, s.bytes += block.size();
+                if (!blocks.push(block, s.full_waits)) break;
+                s.peak_depth = std::max(s.peak_depth, blocks.depth());
+            }
+        } catch (const std::exception &e) {
+            read_error = std::string("block decoder failed: ") + e.what();
+        }
+        blocks.close();
+        s.seconds = seconds_since(start);
+    });
+
+    std::thread tokenizer([&]() {
+        stage_stats &s = stats.tokenizer;
+        const auto start = std::chrono::steady_clock::now();
+        std::string carry, block;
+        uint64_t base = 0;
+        bool operand = false; // carried across blocks, like the text
+        size_t scanned = 0;   // bytes of carry read into a token the end cut, not scanned again
+
+        // lexes carry, keeping a token the end may have cut for the next block
+        const auto lex = [&](bool more) {
+            token_chunk chunk;
+            chunk.base = base;
+            size_t offset = 0;
+            for (;;) {
+                auto e = lexer.next(carry, offset, more, operand, &scanned);
+                if (e.is_right()) {
+                    operand = tokens::ends_operand(e.get_right().id);
+                    chunk.tokens.push_back(e.get_right());
+                    continue;
+                }
+                if (e.get_left() != token_errors::end_of_input) {
+                    lex_error = std::string(tokens::message_of(e.get_left())) + " at " + std::to_string(base + offset);
+                    return false;
+                }
+                break;
+            }
+
+            if (offset == 0) {
+                return true; // carry is all one cut token, kept as is
+            }
+            chunk.text.assign(carry, 0, offset);
+            carry.erase(0, offset);
+            scanned = scanned > offset ? scanned - offset : 0;
+            base += offset;
+            s.bytes += offset, s.tokens += chunk.tokens.size();
+            if (chunk.tokens.empty()) {
+                return true;
+            }
+            s.items++;
+            if (!chunks.push(chunk, s.full_waits)) return false;
+            s.peak_depth = std::max(s.peak_depth, chunks.depth());
+            return true;
+        };
+
+        bool ok = true;
+        while (ok && blocks.pop(block, s.empty_waits)) {
+            carry.append(block);
+            ok = lex(true);
+        }
+        if (ok && read_error.empty()) {
+            lex(false);
+        }
+        blocks.close();
+        chunks.close();
+        s.seconds = seconds_since(start);
+    });
+
+    stage_stats &s = stats.consumer;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        for (token_chunk chunk; chunks.pop(chunk, s.empty_waits);) {
+            consume(chunk);
+            s.items++, s.bytes += chunk.text.size(), s.tokens += chunk.tokens.size();
+        }
+    } catch (...) {
+        chunks.close();
+        blocks.close();
+        tokenizer.join();
+        reader.join();
+        throw;
+    }
+    s.seconds = seconds_since(start);
+    tokenizer.join();
+    reader.join();
+
+    if (!read_error.empty()) {
+        return left(std::move(read_error));
+    }
+    if (!lex_error.empty()) {
+        return left(std::move(lex_error));
+    }
+    return right(std::move(stats));
+}
+
+} // namespace tokenizes::pipelines
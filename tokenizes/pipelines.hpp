@@ -0,0 +1,150 @@
+#pragma once
+#include "either.hpp"
+#include "lazies.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+namespace tokenizes::pipelines {
+
+using tokenizes::eithers::either;
+using tokenizes::tokens::compact_token;
+
+/** bounded single-producer single-consumer queue
+ * head and tail live on separate cache lines, and each side caches the other's index,
+ * so the shared indices are only reloaded when the queue looks full (or empty).
+ * close() ends the stream from either side: push then fails, pop drains what is left.
+ */
+template <class T>
+class spsc_ring {
+    constexpr static size_t line = 64;
+
+    std::unique_ptr<T[]> items;
+    size_t mask;
+    alignas(line) std::atomic<size_t> head{0}; // next item to pop, written by the consumer
+    alignas(line) std::atomic<size_t> tail{0}; // next slot to push, written by the producer
+    alignas(line) size_t cached_head{0};       // producer's view of head
+    alignas(line) size_t cached_tail{0};       // consumer's view of tail
+    alignas(line) std::atomic<bool> closed{false};
+
+    static size_t capacity_of(size_t capacity) { return std::bit_ceil(std::max<size_t>(capacity, 2)); }
+
+public:
+    spsc_ring(size_t capacity) : items(std::make_unique<T[]>(capacity_of(capacity))), mask(capacity_of(capacity) - 1) {}
+    spsc_ring(const spsc_ring &) = delete;
+
+    // moves item in unless the queue is full
+    bool try_push(T &item) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head > mask) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head > mask) return false;
+        }
+        items[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &item) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail) return false;
+        }
+        item = std::move(items[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // waits while full (backpressure), false once closed; waits counts the yields
+    bool push(T &item, uint64_t &waits) {
+        while (!closed.load(std::memory_order_acquire)) {
+            if (try_push(item)) return true;
+            waits++;
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    // waits while empty, false once closed and drained
+    bool pop(T &item, uint64_t &waits) {
+        while (!try_pop(item)) {
+            if (closed.load(std::memory_order_acquire)) {
+                return try_pop(item);
+            }
+            waits++;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    void close() { closed.store(true, std::memory_order_release); }
+    size_t depth() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+    size_t capacity() const { return mask + 1; }
+};
+
+// tokens of a stretch of the input, with the bytes they span
+struct token_chunk {
+    uint64_t base{0}; // input offset of text[0]
+    std::string text;
+    std::vector<compact_token> tokens; // offsets into text
+
+    std::string_view text_of(const compact_token &t) const { return std::string_view(text).substr(t.offset, t.length); }
+};
+
+// decodes one raw block (e.g. decompresses it), appending to out
+using block_decoder = std::function<void(std::string_view block, std::string &out)>;
+
+struct stage_stats {
+    uint64_t items{0}; // blocks or chunks handled
+    uint64_t bytes{0}; // decoded bytes
+    uint64_t tokens{0};
+    uint64_t full_waits{0};  // yields on a full output queue (backpressure)
+    uint64_t empty_waits{0}; // yields on an empty input queue (starvation)
+    size_t peak_depth{0};    // deepest the output queue was seen
+    double seconds{0};
+
+    double bytes_per_second() const { return seconds > 0 ? bytes / seconds : 0; }
+    double tokens_per_second() const { return seconds > 0 ? tokens / seconds : 0; }
+};
+
+struct pipeline_stats {
+    stage_stats reader, tokenizer, consumer;
+};
+
+struct pipeline_options {
+    size_t block_size{64 * 1024};
+    size_t queue_capacity{8};
+    block_decoder decoder{}; // empty: blocks are lexed as read
+};
+
+/** reader -> tokenizer -> consumer, connected by spsc_rings
+ * the reader thread reads and decodes blocks, the tokenizer thread lexes them with span_lexer
+ * (a token cut by a block boundary is carried into the next block), and the consumer runs on the calling thread.
+ * a full queue stalls the stage feeding it, so memory stays bounded by the queue capacities.
+ */
+class token_pipeline {
+    pipeline_options options;
+    tokens::span_lexer lexer;
+
+public:
+    using consumer = std::function<void(const token_chunk &)>;
+
+    token_pipeline(pipeline_options _options = {}, tokens::span_lexer _lexer = {})
+        : options(std::move(_options)), lexer(std::move(_lexer)) {}
+
+    // statistics per stage, or the first error with its input offset
+    either<pipeline_stats, std::string> run(std::istream &source, const consumer &consume) const;
+    const tokens::span_lexer &get_lexer() const { return lexer; }
+};
+
+} // namespace tokenizes::pipelines
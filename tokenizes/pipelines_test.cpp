@@ -0,0 +1,167 @@
+#include "lazies.hpp"
+#include "pipelines.hpp"
+
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tokenizes::pipelines;
+using tokenizes::tokens::span_lexer;
+using tokenizes::tokens::token_id;
+
+namespace pipelines_tests {
+
+TEST(spsc_ring, in_order) {
+    spsc_ring<int> ring(4);
+    EXPECT_EQ(ring.capacity(), 4);
+
+    std::thread producer([&]() {
+        uint64_t waits = 0;
+        for (int i = 0; i < 10000; i++) {
+            int item = i;
+            ASSERT_TRUE(ring.push(item, waits));
+        }
+        ring.close();
+    });
+
+    uint64_t waits = 0;
+    int expected = 0;
+    for (int item; ring.pop(item, waits); expected++) {
+        ASSERT_EQ(item, expected);
+    }
+    producer.join();
+    EXPECT_EQ(expected, 10000);
+}
+
+TEST(spsc_ring, full) {
+    spsc_ring<std::string> ring(2);
+    std::string a = "a", b = "b", c = "c";
+    EXPECT_TRUE(ring.try_push(a));
+    EXPECT_TRUE(ring.try_push(b));
+    EXPECT_FALSE(ring.try_push(c));
+    EXPECT_EQ(c, "c");
+    EXPECT_EQ(ring.depth(), 2);
+
+    std::string item;
+    EXPECT_TRUE(ring.try_pop(item));
+    EXPECT_EQ(item, "a");
+    ring.close();
+    uint64_t waits = 0;
+    EXPECT_FALSE(ring.push(c, waits));
+    EXPECT_TRUE(ring.pop(item, waits));
+    EXPECT_EQ(item, "b");
+    EXPECT_FALSE(ring.pop(item, waits));
+}
+
+// (absolute offset, id, text) of every token
+struct seen {
+    uint64_t offset;
+    token_id id;
+    std::string text;
+    bool operator==(const seen &) const = default;
+};
+
+static std::vector<seen> through(const std::string &input, pipeline_options options) {
+    std::vector<seen> tokens;
+    std::stringstream ss(input);
+    const auto e = token_pipeline(std::move(options)).run(ss, [&](const token_chunk &chunk) {
+        for (const auto &t : chunk.tokens) {
+            tokens.push_back({chunk.base + t.offset, t.id, std::string(chunk.text_of(t))});
+        }
+    });
+    EXPECT_TRUE(e.is_right());
+    return tokens;
+}
+
+TEST(token_pipeline, block_boundaries) {
+    const std::string input = "x = -12 + 0x1F * (3.5e2 - y_1) / 'a\\nb c' % \"q\" true false 0b101 +7 - 2.25 _z9\n"
+                              "total = 'long text spanning blocks' + 123456789 - 1.5e-3\n";
+    const auto whole = span_lexer().tokenize(input);
+    ASSERT_TRUE(whole.is_right());
+    std::vector<seen> expected;
+    for (const auto &t : whole.get_right().get_tokens()) {
+        expected.push_back({t.offset, t.id, std::string(input.substr(t.offset, t.length))});
+    }
+
+    for (const size_t block : {1, 2, 3, 5, 7, 16, 4096}) {
+        pipeline_options options;
+        options.block_size = block;
+        options.queue_capacity = 2;
+        EXPECT_EQ(through(input, options), expected) << block;
+    }
+}
+
+TEST(token_pipeline, long_tokens) {
+    const std::string text = "'" + std::string(5000, 'a') + "\\n" + std::string(5000, 'b') + "'";
+    const std::string name = "n" + std::string(3000, '1');
+    const std::string input = "x = " + text + " + " + name + " 1";
+    const std::vector<seen> expected{{0, token_id::variable, "x"},
+                                     {2, token_id::assign, "="},
+                                     {4, token_id::text, text},
+                                     {4 + text.size() + 1, token_id::add, "+"},
+                                     {4 + text.size() + 3, token_id::variable, name},
+                                     {4 + text.size() + 4 + name.size(), token_id::integer, "1"}};
+    for (const size_t block : {3, 64}) {
+        pipeline_options options;
+        options.block_size = block;
+        EXPECT_EQ(through(input, options), expected) << block;
+    }
+}
+
+TEST(token_pipeline, decoder) {
+    const std::string plain = "a + 'b' * 3";
+    std::string encoded = plain;
+    for (char &c : encoded) {
+        c ^= 0x5a;
+    }
+
+    pipeline_options options;
+    options.block_size = 4;
+    options.decoder = [](std::string_view block, std::string &out) {
+        for (const char c : block) {
+            out.push_back(static_cast<char>(c ^ 0x5a));
+        }
+    };
+    const auto tokens = through(encoded, options);
+    ASSERT_EQ(tokens.size(), 5);
+    EXPECT_EQ(tokens[2].text, "'b'");
+    EXPECT_EQ(tokens[4].offset, 10);
+}
+
+TEST(token_pipeline, stats) {
+    std::string input;
+    for (int i = 0; i < 1000; i++) {
+        input += "name_" + std::to_string(i) + " = " + std::to_string(i) + "\n";
+    }
+    pipeline_options options;
+    options.block_size = 256;
+    std::stringstream ss(input);
+    const auto e = token_pipeline(options).run(ss, [](const token_chunk &) {});
+    ASSERT_TRUE(e.is_right());
+    const pipeline_stats &stats = e.get_right();
+    EXPECT_EQ(stats.reader.bytes, input.size());
+    EXPECT_EQ(stats.reader.items, (input.size() + 255) / 256);
+    EXPECT_EQ(stats.tokenizer.bytes, input.size());
+    EXPECT_EQ(stats.tokenizer.tokens, 3000);
+    EXPECT_EQ(stats.consumer.tokens, 3000);
+    EXPECT_LE(stats.reader.peak_depth, 8);
+}
+
+TEST(token_pipeline, error) {
+    pipeline_options options;
+    options.block_size = 3;
+    std::stringstream ss("abc = 1 $ 2");
+    const auto e = token_pipeline(options).run(ss, [](const token_chunk &) {});
+    ASSERT_TRUE(e.is_left());
+    EXPECT_EQ(e.get_left(), "unexpected character at 8");
+}
+
+TEST(token_pipeline, unterminated) {
+    std::stringstream ss("a 'open");
+    const auto e = token_pipeline().run(ss, [](const token_chunk &) {});
+    ASSERT_TRUE(e.is_left());
+}
+
+} // namespace pipelines_tests
@@ -82,19 +82,42 @@ either<char, std::nullptr_t> atom::operator()(std::istream &ss) const {
     return right(input);
 }
 
-either<std::string, std::nullptr_t> tag::operator()(std::istream &ss) const {
-    std::string r;
+bool tag::match(std::istream &ss) const {
+    probes::scope<probes::probe, std::istream> call(probe, ss);
     auto pos = ss.tellg();
     for (const char c : str) {
         const int input = ss.get();
         if (input != (int)c) {
+            call.rewinding(pos);
             ss.seekg(pos);
-            return left(nullptr);
+            return false;
         }
     }
+    call.succeeded();
+    return true;
+}
+
+either<std::string, std::nullptr_t> tag::operator()(std::istream &ss) const {
+    if (!match(ss)) {
+        return left(nullptr);
+    }
     return right(str);
 }
 
+either<std::pmr::string, std::nullptr_t> pmr_tag::operator()(std::istream &ss) const {
+    if (!parser.match(ss)) {
+        return left(nullptr);
+    }
+    return right(std::pmr::string(parser.str, contexts::resource_of(ss)));
+}
+
+std::bitset<256> tag::first() const {
+    if (str.empty()) {
+        return std::bitset<256>().set();
+    }
+    return std::bitset<256>().set(static_cast<unsigned char>(str[0]));
+}
+
 std::ostream &operator<<(std::ostream &os, const tag &t) {
     os << "tag: " << std::quoted(t.get_str());
 
@@ -131,13 +154,13 @@ tag_list::tag_list(std::initializer_list<std::string_view> list) {
     buffer_size = size;
 }
 
-either<std::string, nullptr_t> tag_list::operator()(std::istream &is) const {
-    std::string buffer;
+const std::string *tag_list::match(std::istream &is, std::pmr::memory_resource *scratch) const {
+    probes::scope<probes::probe, std::istream> call(probe, is);
+    std::pmr::string buffer(scratch);
     buffer.reserve(buffer_size);
 
     // rollback info
-    std::string matched;
-    matched.reserve(buffer_size);
+    const std::string *matched = nullptr;
     ssize_t position = is.tellg();
 
     // non-matched loop
@@ -145,21 +168,23 @@ either<std::string, nullptr_t> tag_list::operator()(std::istream &is) const {
         const int input = is.get();
         if (input == -1) {
             // rollback
+            call.rewinding(position);
             is.seekg(position);
-            return left(nullptr);
+            return nullptr;
         }
         buffer.push_back(static_cast<char>(input));
-        const auto iter = table.find(buffer);
+        const auto iter = table.find(std::string_view(buffer));
         if (iter == table.end()) {
             // rollback
+            call.rewinding(position);
             is.seekg(position);
-            return left(nullptr);
+            return nullptr;
         }
 
         if (iter->second) {
             // update rollback
             position = is.tellg();
-            matched = iter->first;
+            matched = &iter->first;
             break;
         }
 
@@ -170,25 +195,58 @@ either<std::string, nullptr_t> tag_list::operator()(std::istream &is) const {
         const int input = is.get();
         if (input == -1) {
             // rollback
+            call.rewinding(position);
             is.seekg(position);
-            return right(matched);
+            call.succeeded();
+            return matched;
         }
         buffer.push_back(static_cast<char>(input));
-        const auto iter = table.find(buffer);
+        const auto iter = table.find(std::string_view(buffer));
         if (iter == table.end()) {
             // rollback
+            call.rewinding(position);
             is.seekg(position);
-            return right(matched);
+            call.succeeded();
+            return matched;
         }
 
         if (iter->second) {
             // update rollback
             position = is.tellg();
-            matched = iter->first;
+            matched = &iter->first;
         }
     } while (1);
 }
 
+either<std::string, nullptr_t> tag_list::operator()(std::istream &is) const {
+    const std::string *matched = match(is, std::pmr::get_default_resource());
+    if (!matched) {
+        return left(nullptr);
+    }
+    return right(*matched);
+}
+
+either<std::pmr::string, nullptr_t> pmr_tag_list::operator()(std::istream &is) const {
+    std::pmr::memory_resource *resource = contexts::resource_of(is);
+    const std::string *matched = parser.match(is, resource);
+    if (!matched) {
+        return left(nullptr);
+    }
+    return right(std::pmr::string(*matched, resource));
+}
+
+std::bitset<256> tag_list::first() const {
+    std::bitset<256> chars;
+    for (const auto &[key, terminal] : table) {
+        if (key.empty()) {
+            if (terminal) return chars.set();
+            continue;
+        }
+        chars.set(static_cast<unsigned char>(key[0]));
+    }
+    return chars;
+}
+
 tag_list_builder tag_list::builder() { return tag_list_builder(); }
 
 std::ostream &operator<<(std::ostream &os, const tag_list &t) {
@@ -245,9 +303,21 @@ either<int, std::nullptr_t> digit_parser::operator()(std::istream &is) const {
     return left(nullptr);
 }
 
+std::bitset<256> digit_parser::first() const {
+    std::bitset<256> chars;
+    for (unsigned int d = 0; d < base && d < 36; d++) {
+        if (d < 10) {
+            chars.set('0' + d);
+        } else {
+            chars.set('a' + d - 10).set('A' + d - 10);
+        }
+    }
+    return chars;
+}
+
 std::ostream &operator<<(std::ostream &os, const digit_parser &d) { return os << "digit(" << d.get_base() << ")"; }
 
-static inline std::optional<char> escape(char c) {
+std::optional<char> escape_of(char c) {
     switch (c) {
     case 'a':
         return '\a';
@@ -276,39 +346,40 @@ static inline std::optional<char> escape(char c) {
     }
 }
 
-either<std::string, string_errors> string_parser::operator()(std::istream &is) const {
-    const std::streampos pos = is.tellg();
-
-    if (quote(is).is_left()) {
-        return left(string_errors::not_begin);
-    }
-
+either<std::string, string_errors> unescape(std::string_view body) {
     std::string result;
-    while (is) {
-        if (quote(is).is_right()) {
-            return right(result);
+    result.reserve(body.size());
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i] != '\\') {
+            result.push_back(body[i]);
+            continue;
         }
-        
-        const int c = is.get();
-        if (c == '\\') {
-            const int c2 = is.get();
-            if (c2 == -1) {
-                is.seekg(pos);
-                return left(string_errors::not_end);
-            }
-            const auto e = escape(c2);
-            if (!e) {
-                is.seekg(pos);
-                return left(string_errors::bad_escape);
-            }
-            result.push_back(*e);
-        } else {
-            result.push_back(c);
+        if (++i == body.size()) {
+            return left(string_errors::not_end);
         }
+        const auto e = escape_of(body[i]);
+        if (!e) {
+            return left(string_errors::bad_escape);
+        }
+        result.push_back(*e);
     }
+    return right(std::move(result));
+}
 
-    is.seekg(pos);
-    return left(string_errors::not_end);
+either<std::string, string_errors> string_parser::operator()(std::istream &is) const {
+    std::string buffer;
+    if (auto e = (*this)(is, buffer); e.is_left()) {
+        return left(e.get_left());
+    }
+    return right(std::move(buffer));
+}
+
+either<std::pmr::string, string_errors> pmr_string_parser::operator()(std::istream &is) const {
+    std::pmr::string buffer(contexts::resource_of(is));
+    if (auto e = parser(is, buffer); e.is_left()) {
+        return left(e.get_left());
+    }
+    return right(std::move(buffer));
 }
 
 either<std::string, raw_string_errors> raw_string_parser::operator()(std::istream &is) const {
@@ -322,7 +393,7 @@ either<std::string, raw_string_errors> raw_string_parser::operator()(std::istrea
     std::string result;
     while (is) {
         if (quote(is).is_right()) {
-            return right(result);
+            return right(std::move(result));
         }
         result.push_back(is.get());
     }
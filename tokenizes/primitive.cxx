@@ -1,5 +1,6 @@
 #pragma once
 #include "primitive.hpp"
+#include <charconv>
 namespace tokenizes::primitive {
 
 template <std::unsigned_integral T>
@@ -18,11 +19,10 @@ either<T, unsigned_errors> unsigned_parser<T>::operator()(std::istream &is) cons
     // lasts
     const unsigned int base = get_base();
     for (either<int, nullptr_t> e = digit(is); e.is_right(); e = digit(is)) {
-        const T limit = std::numeric_limits<T>::max() - result;
         const int d = e.get_right();
 
-        // shift
-        if (result * (base - 1) + d > limit) {
+        // shift, result * base + d > max without overflowing on the way
+        if (result > (std::numeric_limits<T>::max() - d) / base) {
             is.seekg(pos);
             return left(unsigned_errors::overflow);
         }
@@ -55,16 +55,14 @@ either<T, signed_errors> signed_parser<T>::operator()(std::istream &is) const {
     for (either<int, std::nullptr_t> e = digit(is); e.is_right(); e = digit(is)) {
         const int d = e.get_right();
         if (sign) {
-            const T limit = std::numeric_limits<T>::min() - result;
-            if (result * (base - 1) - d < limit) {
+            if (result < (std::numeric_limits<T>::min() + d) / static_cast<T>(base)) {
                 is.seekg(pos);
                 return left(signed_errors::underflow);
             }
             result = result * base - d;
 
         } else {
-            const T limit = std::numeric_limits<T>::max() - result;
-            if (result * (base - 1) + d > limit) {
+            if (result > (std::numeric_limits<T>::max() - d) / static_cast<T>(base)) {
                 is.seekg(pos);
                 return left(signed_errors::overflow);
             }
@@ -104,7 +102,8 @@ either<T, integer_errors> integer_parser<T>::operator()(std::istream &is) const
         case 'x':
             return 16;
         default:
-            is.seekg(pos);
+            // get() may have hit the end and set failbit
+            rewind(is, pos);
             return 10;
         }
     }(is);
@@ -123,16 +122,14 @@ either<T, integer_errors> integer_parser<T>::operator()(std::istream &is) const
     for (either<int, std::nullptr_t> e = digit(is); e.is_right(); e = digit(is)) {
         const int d = e.get_right();
         if (sign) {
-            const T limit = std::numeric_limits<T>::min() - result;
-            if (result * (base - 1) - d < limit) {
+            if (result < (std::numeric_limits<T>::min() + d) / static_cast<T>(base)) {
                 is.seekg(pos);
                 return left(integer_errors::underflow);
             }
             result = result * base - d;
 
         } else {
-            const T limit = std::numeric_limits<T>::max() - result;
-            if (result * (base - 1) + d > limit) {
+            if (result > (std::numeric_limits<T>::max() - d) / static_cast<T>(base)) {
                 is.seekg(pos);
                 return left(integer_errors::overflow);
             }
@@ -143,4 +140,178 @@ either<T, integer_errors> integer_parser<T>::operator()(std::istream &is) const
     return right(result);
 }
 
-} // namespace tokenizes::primitive
\ No newline at end of file
+template <std::floating_point T>
+either<T, real_errors> real_parser<T>::operator()(std::istream &is) const {
+    const std::streampos pos = is.tellg();
+    // literals of up to 64 characters are collected without touching the heap
+    smalls::small_string<64> buffer;
+
+    const auto digits = [&is, &buffer]() -> bool {
+        const size_t size = buffer.size();
+        for (int c = is.peek(); '0' <= c && c <= '9'; c = is.peek()) {
+            buffer.push_back(static_cast<char>(c));
+            is.ignore();
+        }
+        return buffer.size() != size;
+    };
+    const auto fail = [&is, pos](real_errors error) {
+        rewind(is, pos);
+        return left(error);
+    };
+
+    // [+-]?
+    if (const int s = is.peek(); s == '+' || s == '-') {
+        if (s == '-') buffer.push_back('-');
+        is.ignore();
+    }
+
+    // [0-9]+\.[0-9]+
+    if (!digits()) {
+        return fail(real_errors::not_digit);
+    }
+    if (is.peek() != '.') {
+        return fail(real_errors::not_dot);
+    }
+    buffer.push_back(static_cast<char>(is.get()));
+    if (!digits()) {
+        return fail(real_errors::not_fraction);
+    }
+
+    // ([eE][+-]?[0-9]+)?
+    if (const int e = is.peek(); e == 'e' || e == 'E') {
+        buffer.push_back(static_cast<char>(is.get()));
+        if (const int s = is.peek(); s == '+' || s == '-') {
+            buffer.push_back(static_cast<char>(is.get()));
+        }
+        if (!digits()) {
+            return fail(real_errors::not_exponent);
+        }
+    }
+
+    T result;
+    const auto [end, ec] = std::from_chars(buffer.data(), buffer.data() + buffer.size(), result);
+    if (ec != std::errc()) {
+        return fail(real_errors::out_of_range);
+    }
+    return right(result);
+}
+
+template <std::signed_integral T>
+either<T, integer_errors> integer_from(std::string_view text, size_t &used) {
+    size_t i = 0;
+    // [+-]?
+    bool sign = false;
+    if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+        sign = text[i++] == '-';
+    }
+
+    // {0b,0q,0o,0d,0x}?
+    int base = 10;
+    if (i + 1 < text.size() && text[i] == '0') {
+        switch (text[i + 1]) {
+        case 'b':
+            base = 2, i += 2;
+            break;
+        case 'q':
+            base = 4, i += 2;
+            break;
+        case 'o':
+            base = 8, i += 2;
+            break;
+        case 'd':
+            base = 10, i += 2;
+            break;
+        case 'x':
+            base = 16, i += 2;
+            break;
+        default:
+            break;
+        }
+    }
+
+    const auto to_digit = [base](char c) -> int {
+        int d = 36;
+        if ('0' <= c && c <= '9') d = c - '0';
+        else if ('a' <= c && c <= 'z') d = c - 'a' + 10;
+        else if ('A' <= c && c <= 'Z') d = c - 'A' + 10;
+        return d < base ? d : -1;
+    };
+
+    if (i >= text.size() || to_digit(text[i]) < 0) {
+        return left(integer_errors::not_digit);
+    }
+    T result = 0;
+    for (int d; i < text.size() && (d = to_digit(text[i])) >= 0; i++) {
+        if (sign) {
+            if (result < (std::numeric_limits<T>::min() + d) / static_cast<T>(base)) {
+                return left(integer_errors::underflow);
+            }
+            result = result * base - d;
+        } else {
+            if (result > (std::numeric_limits<T>::max() - d) / static_cast<T>(base)) {
+                return left(integer_errors::overflow);
+            }
+            result = result * base + d;
+        }
+    }
+    used = i;
+    return right(result);
+}
+
+template <std::floating_point T>
+either<T, real_errors> real_from(std::string_view text) {
+    // from_chars takes no plus sign
+    if (!text.empty() && text[0] == '+') {
+        text.remove_prefix(1);
+    }
+    T result;
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), result);
+    if (ec != std::errc()) {
+        return left(ec == std::errc::result_out_of_range ? real_errors::out_of_range : real_errors::not_digit);
+    }
+    return right(result);
+}
+
+template <class S>
+    requires std::same_as<S, std::string> || std::same_as<S, std::pmr::string>
+either<std::string_view, string_errors> string_parser::operator()(std::istream &is, S &buffer) const {
+    probes::scope<probes::probe, std::istream> call(probe, is);
+    const std::streampos pos = is.tellg();
+
+    if (quote(is).is_left()) {
+        return left(string_errors::not_begin);
+    }
+
+    buffer.clear();
+    while (is) {
+        if (quote(is).is_right()) {
+            call.succeeded();
+            return right(std::string_view(buffer));
+        }
+
+        const int c = is.get();
+        if (c == '\\') {
+            const int c2 = is.get();
+            if (c2 == -1) {
+                call.rewinding(pos);
+                is.seekg(pos);
+                return left(string_errors::not_end);
+            }
+            const auto e = escape_of(c2);
+            if (!e) {
+                call.rewinding(pos);
+                is.seekg(pos);
+                return left(string_errors::bad_escape);
+            }
+            buffer.push_back(*e);
+        } else {
+            buffer.push_back(c);
+        }
+    }
+
+    call.rewinding(pos);
+    is.seekg(pos);
+    return left(string_errors::not_end);
+}
+
+} // namespace tokenizes::primitive
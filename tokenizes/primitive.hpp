@@ -1,15 +1,21 @@
 #pragma once
 
+#include "contexts.hpp"
 #include "either.hpp"
+#include "probes.hpp"
+#include "smalls.hpp"
 #include <bitset>
 #include <cassert>
 #include <cmath>
+#include <concepts>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <ranges>
 #include <string>
@@ -22,6 +28,17 @@ using tokenizes::eithers::either;
 using tokenizes::eithers::left;
 using tokenizes::eithers::right;
 
+// peek() at the end sets eofbit and a further read sets failbit, after which tellg/seekg refuse to work
+static inline std::streampos tell(std::istream &is) {
+    if (is.eof()) is.clear();
+    return is.tellg();
+}
+
+static inline void rewind(std::istream &is, std::streampos pos) {
+    if (is.eof()) is.clear();
+    is.seekg(pos);
+}
+
 class atom {
     using chars_t = std::bitset<256>;
     chars_t chars;
@@ -42,6 +59,7 @@ public:
     either<char, std::nullptr_t> operator()(std::istream &ss) const;
 
     const chars_t &get_chars() const { return chars; }
+    chars_t first() const { return chars; }
 
     atom operator+(const atom &x) const { return atom(chars | x.chars); }
     atom operator-(const atom &x) const { return atom(chars & ~x.chars); }
@@ -70,31 +88,78 @@ static inline atom hexdigit = digit + atom::from_range('a', 'f') + atom::from_ra
 
 class tag {
     std::string str;
+    [[no_unique_address]] probes::probe probe;
+
+    // consumes str, or rewinds
+    bool match(std::istream &ss) const;
+
+    friend class pmr_tag;
 
 public:
-    tag(std::string_view sv) : str(sv) {}
+    tag(std::string_view sv) : str(sv), probe("tag", sv) {}
     tag &set(std::string_view sv) { return str = sv, *this; }
     either<std::string, std::nullptr_t> operator()(std::istream &ss) const;
     const std::string &get_str() const { return str; }
+    std::bitset<256> first() const;
 };
 
 std::ostream &operator<<(std::ostream &, const tag &);
 
+// tag whose match is allocated from the input's resource (see contexts::resource_scope)
+class pmr_tag {
+    tag parser;
+
+public:
+    pmr_tag(std::string_view sv) : parser(sv) {}
+    either<std::pmr::string, std::nullptr_t> operator()(std::istream &ss) const;
+    const std::string &get_str() const { return parser.get_str(); }
+    std::bitset<256> first() const { return parser.first(); }
+};
+
+// hashes std::string keys and std::string_view probes alike
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view sv) const { return std::hash<std::string_view>()(sv); }
+};
+
 class tag_list_builder;
 class tag_list {
-    std::unordered_map<std::string, bool> table;
+public:
+    // prefixes of the items, true where an item ends
+    using table_t = std::unordered_map<std::string, bool, string_hash, std::equal_to<>>;
+
+private:
+    table_t table;
     size_t buffer_size;
+    [[no_unique_address]] probes::probe probe{"tag_list"};
+
+    // the longest item at the input, or rewinds and returns null; prefixes are read into scratch
+    const std::string *match(std::istream &is, std::pmr::memory_resource *scratch) const;
+
+    friend class pmr_tag_list;
 
 public:
     tag_list(const std::vector<std::string> &list);
     tag_list(std::initializer_list<std::string_view> list);
     either<std::string, nullptr_t> operator()(std::istream &) const;
-    const std::unordered_map<std::string, bool> &get_table() const { return table; }
+    const table_t &get_table() const { return table; }
+    std::bitset<256> first() const;
     static tag_list_builder builder();
 };
 
 std::ostream &operator<<(std::ostream &, const tag_list &);
 
+// tag_list whose match is allocated from the input's resource
+class pmr_tag_list {
+    tag_list parser;
+
+public:
+    pmr_tag_list(const std::vector<std::string> &list) : parser(list) {}
+    pmr_tag_list(std::initializer_list<std::string_view> list) : parser(list) {}
+    either<std::pmr::string, nullptr_t> operator()(std::istream &) const;
+    std::bitset<256> first() const { return parser.first(); }
+};
+
 class tag_list_builder {
     std::vector<std::string> items;
 
@@ -111,6 +176,7 @@ public:
     digit_parser(unsigned int _base) : base(_base) {}
     either<int, std::nullptr_t> operator()(std::istream &) const;
     unsigned int get_base() const { return base; }
+    std::bitset<256> first() const;
 };
 
 std::ostream &operator<<(std::ostream &, const digit_parser &);
@@ -126,6 +192,7 @@ public:
     unsigned_parser(unsigned int _base = 10) : digit(_base) {}
     either<T, unsigned_errors> operator()(std::istream &is) const;
     unsigned int get_base() const { return digit.get_base(); }
+    std::bitset<256> first() const { return digit.first(); }
 };
 
 template <std::unsigned_integral T>
@@ -144,6 +211,7 @@ public:
     signed_parser(unsigned int _base = 10) : digit(_base) {}
     either<T, signed_errors> operator()(std::istream &is) const;
     unsigned int get_base() const { return digit.get_base(); }
+    std::bitset<256> first() const { return digit.first() | sign.get_chars(); }
 };
 
 template <std::signed_integral T>
@@ -162,16 +230,58 @@ class integer_parser {
 public:
     integer_parser() = default;
     either<T, integer_errors> operator()(std::istream &is) const;
+    std::bitset<256> first() const { return (sign + digit).get_chars(); }
+};
+
+enum class real_errors { not_digit, not_dot, not_fraction, not_exponent, out_of_range };
+
+// [+-]?[0-9]+\.[0-9]+([eE][+-]?[0-9]+)?
+template <std::floating_point T = float>
+class real_parser {
+public:
+    real_parser() = default;
+    either<T, real_errors> operator()(std::istream &is) const;
+    std::bitset<256> first() const { return (sign + digit).get_chars(); }
 };
 
+/** text-level counterparts of integer_parser / real_parser, for input already in memory
+ * integer_from stops at the first byte that is not a digit of the base and reports it through used.
+ */
+template <std::signed_integral T = int>
+either<T, integer_errors> integer_from(std::string_view text, size_t &used);
+
+template <std::floating_point T = float>
+either<T, real_errors> real_from(std::string_view text);
+
 enum class string_errors { not_begin, not_end, bad_escape };
 
+// body of a string literal (without quotes) with its escapes resolved
+either<std::string, string_errors> unescape(std::string_view body);
+// character that the escape sequence \c stands for
+std::optional<char> escape_of(char c);
+
 class string_parser {
     tag quote;
+    [[no_unique_address]] probes::probe probe;
 
 public:
-    string_parser(std::string_view _quote = "'") : quote(_quote) {}
+    string_parser(std::string_view _quote = "'") : quote(_quote), probe("string_parser", _quote) {}
     either<std::string, string_errors> operator()(std::istream &is) const;
+    // decodes the body into buffer (std::string or std::pmr::string), whose capacity is kept across calls
+    template <class S>
+        requires std::same_as<S, std::string> || std::same_as<S, std::pmr::string>
+    either<std::string_view, string_errors> operator()(std::istream &is, S &buffer) const;
+    std::bitset<256> first() const { return quote.first(); }
+};
+
+// string_parser whose body is allocated from the input's resource
+class pmr_string_parser {
+    string_parser parser;
+
+public:
+    pmr_string_parser(std::string_view _quote = "'") : parser(_quote) {}
+    either<std::pmr::string, string_errors> operator()(std::istream &is) const;
+    std::bitset<256> first() const { return parser.first(); }
 };
 
 enum class raw_string_errors { not_begin, not_end };
@@ -182,6 +292,7 @@ class raw_string_parser {
 public:
     raw_string_parser(std::string_view _quote = "\"\"\"") : quote(_quote) {}
     either<std::string, raw_string_errors> operator()(std::istream &is) const;
+    std::bitset<256> first() const { return quote.first(); }
 };
 
 } // namespace tokenizes::primitive
@@ -0,0 +1,93 @@
+#include "benches.hpp"
+#include "mappers.hpp"
+#include "primitive.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace tokenizes::primitive;
+using tokenizes::benches::items;
+using tokenizes::benches::pick;
+using tokenizes::benches::run_items;
+
+namespace primitive_bench {
+
+constexpr size_t corpus_size = 64 << 10;
+
+const static char *const keywords[] = {"if", "else", "while", "for", "return", "break", "continue", "switch"};
+
+static void atom_alnum(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &random) {
+        const static std::string chars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+        return std::string(1, chars[random() % chars.size()]);
+    });
+    run_items(state, alnum, text);
+}
+BENCHMARK(atom_alnum);
+
+static void tag_keyword(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &) { return std::string("return"); });
+    run_items(state, tag("return"), text);
+}
+BENCHMARK(tag_keyword);
+
+static void tag_list_keywords(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &random) { return pick(random, keywords); });
+    run_items(state, tag_list({"if", "else", "while", "for", "return", "break", "continue", "switch"}), text);
+}
+BENCHMARK(tag_list_keywords);
+
+static void tag_mapper_keywords(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &random) { return pick(random, keywords); });
+    const tokenizes::mappers::tag_mapper<int> parser{{"if", 0},     {"else", 1},  {"while", 2},    {"for", 3},
+                                                     {"return", 4}, {"break", 5}, {"continue", 6}, {"switch", 7}};
+    run_items(state, parser, text);
+}
+BENCHMARK(tag_mapper_keywords);
+
+static void integer_parser_bases(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &random) {
+        const static char *const prefixes[] = {"", "", "", "-", "0x", "0b", "0o"};
+        const std::string prefix = pick(random, prefixes);
+        const unsigned value = random() % 100000;
+        if (prefix == "0x") {
+            std::stringstream ss;
+            ss << prefix << std::hex << value;
+            return ss.str();
+        }
+        if (prefix == "0b") {
+            std::string digits;
+            for (unsigned v = value % 4096; v; v /= 2) {
+                digits.insert(digits.begin(), static_cast<char>('0' + v % 2));
+            }
+            return prefix + (digits.empty() ? "0" : digits);
+        }
+        if (prefix == "0o") {
+            std::stringstream ss;
+            ss << prefix << std::oct << value;
+            return ss.str();
+        }
+        return prefix + std::to_string(value);
+    });
+    run_items(state, integer_parser<int>(), text);
+}
+BENCHMARK(integer_parser_bases);
+
+static void real_parser_decimal(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &random) {
+        return std::to_string(random() % 10000) + "." + std::to_string(random() % 1000) +
+               (random() % 4 ? "" : "e-" + std::to_string(random() % 10));
+    });
+    run_items(state, real_parser<float>(), text);
+}
+BENCHMARK(real_parser_decimal);
+
+static void string_parser_escapes(benchmark::State &state) {
+    const std::string text = items(corpus_size, [](std::mt19937 &random) {
+        const static char *const bodies[] = {"hello", "a\\tb", "line\\n", "it\\'s", "some longer text in quotes", ""};
+        return "'" + pick(random, bodies) + "'";
+    });
+    run_items(state, string_parser("'"), text);
+}
+BENCHMARK(string_parser_escapes);
+
+} // namespace primitive_bench
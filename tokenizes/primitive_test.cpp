@@ -387,6 +387,13 @@ TEST(integer_parser, base10_over) {
     EXPECT_EQ(parser(ss).opt_right(), 10);
 }
 
+TEST(integer_parser, zero_at_end) {
+    const auto parser = integer_parser();
+    std::stringstream ss;
+    ss << "0";
+    EXPECT_EQ(parser(ss).opt_right(), 0);
+}
+
 TEST(integer_parser, base16_pass) {
     const auto parser = integer_parser();
     std::stringstream ss;
@@ -431,6 +438,53 @@ TEST(integer_parser, base16_underflow_deny) {
 
 } // namespace integer_parser_tests
 
+namespace real_parser_tests {
+
+TEST(real_parser, pass) {
+    const auto parser = real_parser();
+    std::stringstream ss;
+    ss << "1.5";
+    EXPECT_EQ(parser(ss).opt_right(), 1.5f);
+}
+
+TEST(real_parser, sign) {
+    const auto parser = real_parser();
+    std::stringstream ss;
+    ss << "-0.25";
+    EXPECT_EQ(parser(ss).opt_right(), -0.25f);
+}
+
+TEST(real_parser, exponent) {
+    const auto parser = real_parser<double>();
+    std::stringstream ss;
+    ss << "1.5e+2";
+    EXPECT_EQ(parser(ss).opt_right(), 150.0);
+}
+
+TEST(real_parser, not_dot) {
+    const auto parser = real_parser();
+    std::stringstream ss;
+    ss << "12";
+    EXPECT_EQ(parser(ss).opt_left(), real_errors::not_dot);
+    EXPECT_EQ(ss.tellg(), 0);
+}
+
+TEST(real_parser, not_fraction) {
+    const auto parser = real_parser();
+    std::stringstream ss;
+    ss << "1.x";
+    EXPECT_EQ(parser(ss).opt_left(), real_errors::not_fraction);
+}
+
+TEST(real_parser, not_exponent) {
+    const auto parser = real_parser();
+    std::stringstream ss;
+    ss << "1.0e";
+    EXPECT_EQ(parser(ss).opt_left(), real_errors::not_exponent);
+}
+
+} // namespace real_parser_tests
+
 namespace string_parser_tests {
 const static auto parser = string_parser("'");
 
@@ -0,0 +1,177 @@
+#include "probes.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+namespace tokenizes::probes {
+
+namespace {
+
+// deque: registered counters never move
+struct registry {
+    std::mutex mutex;
+    std::deque<node_counters> nodes;
+    std::vector<uint32_t> free;                            // slots of released nodes
+    std::unordered_map<std::string, node_counters *> rows; // released counts, by kind and detail
+};
+
+// kind(detail)#id -> kind(detail)
+std::string_view row_of(std::string_view name) {
+    return name.substr(0, name.rfind('#'));
+}
+
+constexpr auto counts = {&node_counters::invocations, &node_counters::successes, &node_counters::failures,
+                         &node_counters::consumed,    &node_counters::rollbacks, &node_counters::rewound};
+
+// a slot of r, reused when one is free; under r.mutex
+node_counters &slot(registry &r) {
+    if (r.free.empty()) {
+        node_counters &c = r.nodes.emplace_back();
+        c.id = static_cast<uint32_t>(r.nodes.size() - 1);
+        return c;
+    }
+    node_counters &c = r.nodes[r.free.back()];
+    r.free.pop_back();
+    return c;
+}
+
+registry &nodes() {
+    static registry r;
+    return r;
+}
+
+std::atomic<size_t> trace_capacity{size_t(1) << 16};
+
+// events[next % size] is written next
+struct trace_ring {
+    std::vector<trace_event> events;
+    uint64_t next{0};
+};
+
+trace_ring &ring() {
+    thread_local trace_ring r;
+    if (r.events.empty()) {
+        r.events.resize(std::max<size_t>(trace_capacity.load(std::memory_order_relaxed), 1));
+    }
+    return r;
+}
+
+} // namespace
+
+node_counters &register_node(std::string_view kind, std::string_view detail) {
+    registry &r = nodes();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    node_counters &c = slot(r);
+    c.name = std::string(kind);
+    if (!detail.empty()) {
+        c.name += "(" + std::string(detail) + ")";
+    }
+    c.name += "#" + std::to_string(c.id);
+    c.owners.store(1, std::memory_order_relaxed);
+    return c;
+}
+
+void retain(node_counters &c) {
+    c.owners.fetch_add(1, std::memory_order_relaxed);
+}
+
+void release(node_counters &c) {
+    if (c.owners.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+    registry &r = nodes();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    node_counters *&row = r.rows[std::string(row_of(c.name))];
+    if (!row) {
+        row = &slot(r);
+        row->name = std::string(row_of(c.name));
+        row->owners.store(1, std::memory_order_relaxed); // never released
+    }
+    for (const auto count : counts) {
+        (row->*count).fetch_add((c.*count).exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    r.free.push_back(c.id);
+}
+
+void report(std::ostream &os) {
+    registry &r = nodes();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<const node_counters *> used;
+    for (const node_counters &c : r.nodes) {
+        if (c.invocations.load(std::memory_order_relaxed)) used.push_back(&c);
+    }
+    std::stable_sort(used.begin(), used.end(), [](const node_counters *x, const node_counters *y) {
+        return x->rewound.load(std::memory_order_relaxed) > y->rewound.load(std::memory_order_relaxed);
+    });
+
+    os << std::left << std::setw(32) << "node" << std::right;
+    for (const char *column : {"calls", "successes", "failures", "consumed", "rollbacks", "rewound"}) {
+        os << std::setw(12) << column;
+    }
+    os << '\n';
+    for (const node_counters *c : used) {
+        os << std::left << std::setw(32) << c->name << std::right;
+        for (const auto *v : {&c->invocations, &c->successes, &c->failures, &c->consumed, &c->rollbacks, &c->rewound}) {
+            os << std::setw(12) << v->load(std::memory_order_relaxed);
+        }
+        os << '\n';
+    }
+}
+
+void reset() {
+    registry &r = nodes();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (node_counters &c : r.nodes) {
+        for (const auto count : counts) {
+            (c.*count).store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::vector<std::string> node_names() {
+    registry &r = nodes();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<std::string> names;
+    names.reserve(r.nodes.size());
+    for (const node_counters &c : r.nodes) {
+        names.push_back(c.name);
+    }
+    return names;
+}
+
+void record(trace_kind kind, uint32_t node, int64_t offset, uint32_t rewound) {
+    trace_ring &r = ring();
+    trace_event &e = r.events[r.next++ % r.events.size()];
+    e.offset = offset;
+    e.node = node;
+    e.kind = static_cast<uint32_t>(kind);
+    e.rewound = rewound;
+}
+
+std::vector<trace_event> recorded() {
+    const trace_ring &r = ring();
+    const size_t size = r.events.size();
+    if (r.next <= size) {
+        return {r.events.begin(), r.events.begin() + r.next};
+    }
+    std::vector<trace_event> events;
+    events.reserve(size);
+    const size_t oldest = r.next % size;
+    events.insert(events.end(), r.events.begin() + oldest, r.events.end());
+    events.insert(events.end(), r.events.begin(), r.events.begin() + oldest);
+    return events;
+}
+
+void clear_trace() { ring().next = 0; }
+
+void set_trace_capacity(size_t events) {
+    trace_capacity.store(events, std::memory_order_relaxed);
+    trace_ring &r = ring();
+    r.events.assign(std::max<size_t>(events, 1), trace_event{});
+    r.next = 0;
+}
+
+} // namespace tokenizes::probes
@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace tokenizes::probes {
+
+/** counters of one parser node
+ * relaxed atomics, so that a shared grammar can be probed from several threads.
+ */
+struct node_counters {
+    std::string name;
+    uint32_t id; // index in the registry; the slot of a destroyed node is reused
+    std::atomic<uint32_t> owners{0}; // probes sharing the node, 0 once released
+    std::atomic<uint64_t> invocations{0}, successes{0}, failures{0};
+    std::atomic<uint64_t> consumed{0}; // bytes (or items) consumed by successful calls
+    std::atomic<uint64_t> rollbacks{0}, rewound{0};
+};
+
+// counters owned by one probe; name gets a #id suffix
+node_counters &register_node(std::string_view kind, std::string_view detail = {});
+// one more probe shares the node
+void retain(node_counters &c);
+/** the node's last probe is gone
+ * its counts move to one row per kind and detail (named without #id), which lives as long as the program,
+ * so parsers built per call add no rows beyond those; its slot is reused by the next registration.
+ */
+void release(node_counters &c);
+// nodes invoked since the last reset, most bytes rewound first
+void report(std::ostream &os);
+void reset();
+// names of every registered node, by id
+std::vector<std::string> node_names();
+
+enum class trace_kind : uint8_t { enter, success, failure, rewind };
+
+/** one entry in the trace ring
+ * offset is the read position at enter and exit, and the target of a rewind;
+ * rewound is the number of bytes a rewind gives back.
+ */
+struct trace_event {
+    int64_t offset;
+    uint32_t node : 24;
+    uint32_t kind : 8;
+    uint32_t rewound;
+};
+static_assert(sizeof(trace_event) == 16);
+
+/** per-thread ring of the last events of tracing probes
+ * once full, the oldest events are overwritten.
+ */
+void record(trace_kind kind, uint32_t node, int64_t offset, uint32_t rewound = 0);
+// events of the calling thread, oldest first
+std::vector<trace_event> recorded();
+void clear_trace();
+// capacity (in events) of rings created afterwards, and of the calling thread's ring
+void set_trace_capacity(size_t events);
+
+template <class I>
+std::streamoff offset_of(I &is) {
+    if constexpr (std::derived_from<I, std::istream>) {
+        // through the buffer, so the stream state is left alone
+        return is.rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+    } else {
+        return static_cast<std::streamoff>(is.tellg());
+    }
+}
+
+// copies of a probed parser share one node, and so one row of the report
+class counting_probe {
+    node_counters *counters;
+
+public:
+    counting_probe(std::string_view kind, std::string_view detail = {}) : counters(&register_node(kind, detail)) {}
+    counting_probe(const counting_probe &p) : counters(p.counters) { retain(*counters); }
+    counting_probe &operator=(const counting_probe &p) {
+        retain(*p.counters);
+        release(*counters);
+        counters = p.counters;
+        return *this;
+    }
+    ~counting_probe() { release(*counters); }
+    node_counters &get_counters() const { return *counters; }
+};
+
+// counting_probe that also records entries, exits and rewinds into the trace ring
+class tracing_probe : public counting_probe {
+public:
+    using counting_probe::counting_probe;
+};
+
+// what a node holds when probing is off: empty, so [[no_unique_address]] takes no space
+class null_probe {
+public:
+    constexpr null_probe(std::string_view, std::string_view = {}) {}
+};
+
+#if defined(TOKENIZES_TRACE)
+using probe = tracing_probe;
+#elif defined(TOKENIZES_PROBES)
+using probe = counting_probe;
+#else
+using probe = null_probe;
+#endif
+
+/** one call of a probed node
+ * counted as a failure unless succeeded() is called; consumed bytes are measured when it ends.
+ */
+template <class P, class I>
+class scope {
+protected:
+    node_counters &counters;
+    I &is;
+    std::streamoff begin;
+    bool ok{false};
+
+public:
+    scope(const P &probe, I &_is) : counters(probe.get_counters()), is(_is), begin(offset_of(_is)) {
+        counters.invocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    scope(const scope &) = delete;
+    ~scope() {
+        if (ok) {
+            counters.successes.fetch_add(1, std::memory_order_relaxed);
+            counters.consumed.fetch_add(offset_of(is) - begin, std::memory_order_relaxed);
+        } else {
+            counters.failures.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void succeeded() { ok = true; }
+    // the node is about to seek back to pos
+    template <class Pos>
+    void rewinding(Pos pos) {
+        counters.rollbacks.fetch_add(1, std::memory_order_relaxed);
+        counters.rewound.fetch_add(offset_of(is) - static_cast<std::streamoff>(pos), std::memory_order_relaxed);
+    }
+};
+
+template <class I>
+class scope<tracing_probe, I> : public scope<counting_probe, I> {
+    using base = scope<counting_probe, I>;
+
+public:
+    scope(const tracing_probe &probe, I &_is) : base(probe, _is) {
+        record(trace_kind::enter, this->counters.id, this->begin);
+    }
+    ~scope() {
+        record(this->ok ? trace_kind::success : trace_kind::failure, this->counters.id, offset_of(this->is));
+    }
+
+    template <class Pos>
+    void rewinding(Pos pos) {
+        const std::streamoff target = static_cast<std::streamoff>(pos);
+        record(trace_kind::rewind, this->counters.id, target, static_cast<uint32_t>(offset_of(this->is) - target));
+        base::rewinding(pos);
+    }
+};
+
+template <class I>
+class scope<null_probe, I> {
+public:
+    constexpr scope(const null_probe &, I &) {}
+    constexpr void succeeded() {}
+    template <class Pos>
+    constexpr void rewinding(Pos) {}
+};
+
+} // namespace tokenizes::probes
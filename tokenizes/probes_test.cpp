@@ -0,0 +1,123 @@
+#include "combinators.hpp"
+#include "primitive.hpp"
+#include "probes.hpp"
+
+#include "gtest/gtest.h"
+#include <concepts>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+using namespace tokenizes::probes;
+using tokenizes::primitive::tag;
+
+namespace probes_tests {
+
+TEST(scope, counts_calls) {
+    const counting_probe probe("test");
+    std::istringstream ss("abcdef");
+    {
+        scope<counting_probe, std::istream> call(probe, ss);
+        ss.ignore(3);
+        call.succeeded();
+    }
+    {
+        scope<counting_probe, std::istream> call(probe, ss);
+        const auto pos = ss.tellg();
+        ss.ignore(2);
+        call.rewinding(pos);
+        ss.seekg(pos);
+    }
+
+    const node_counters &c = probe.get_counters();
+    EXPECT_EQ(c.invocations, 2);
+    EXPECT_EQ(c.successes, 1);
+    EXPECT_EQ(c.failures, 1);
+    EXPECT_EQ(c.consumed, 3);
+    EXPECT_EQ(c.rollbacks, 1);
+    EXPECT_EQ(c.rewound, 2);
+}
+
+TEST(scope, measures_at_end_of_input) {
+    const counting_probe probe("test");
+    std::istringstream ss("ab");
+    {
+        scope<counting_probe, std::istream> call(probe, ss);
+        while (ss.get() != -1) {
+        }
+        call.succeeded();
+    }
+    EXPECT_EQ(probe.get_counters().consumed, 2);
+}
+
+TEST(report, lists_used_nodes) {
+    const counting_probe used("used", "x"), unused("unused");
+    std::istringstream ss("a");
+    {
+        scope<counting_probe, std::istream> call(used, ss);
+    }
+
+    std::ostringstream os;
+    report(os);
+    EXPECT_NE(os.str().find("used(x)#"), std::string::npos);
+    EXPECT_EQ(os.str().find("unused#"), std::string::npos);
+
+    reset();
+    EXPECT_EQ(used.get_counters().invocations, 0);
+}
+
+TEST(registry, copies_share_a_node) {
+    const counting_probe probe("shared");
+    const counting_probe copy = probe;
+    EXPECT_EQ(&copy.get_counters(), &probe.get_counters());
+    EXPECT_EQ(probe.get_counters().owners, 2);
+}
+
+TEST(registry, per_call_probes_fold_into_one_row) {
+    std::istringstream ss("a");
+    const auto call = [&ss] {
+        const counting_probe probe("per_call", "x");
+        scope<counting_probe, std::istream> s(probe, ss);
+    };
+    call();
+    const size_t registered = node_names().size();
+    for (int i = 0; i < 100; i++) {
+        call();
+    }
+    EXPECT_EQ(node_names().size(), registered);
+
+    std::ostringstream os;
+    report(os);
+    const std::string text = os.str();
+    const size_t row = text.find("per_call(x) ");
+    ASSERT_NE(row, std::string::npos) << text;
+    EXPECT_EQ(text.find("per_call(x)", row + 1), std::string::npos) << text;
+    EXPECT_NE(text.find(" 101 ", row), std::string::npos) << text;
+}
+
+TEST(null_probe, takes_no_space) {
+    EXPECT_TRUE(std::is_empty_v<null_probe>);
+    if constexpr (std::is_same_v<probe, null_probe>) {
+        EXPECT_EQ(sizeof(tag), sizeof(std::string));
+    }
+}
+
+TEST(probe, counts_branch_rollbacks) {
+    if constexpr (std::derived_from<probe, counting_probe>) {
+        using tokenizes::combinators::operator+;
+        const auto parser = tag("abc") + tag("abd");
+        std::istringstream ss("abd");
+        reset();
+        EXPECT_TRUE(parser(ss).is_right());
+
+        std::ostringstream os;
+        report(os);
+        // tag("abc") read three bytes before seeking back
+        EXPECT_NE(os.str().find("tag(abc)#"), std::string::npos);
+        EXPECT_NE(os.str().find("branch#"), std::string::npos);
+    } else {
+        GTEST_SKIP() << "built without TOKENIZE_PROBES";
+    }
+}
+
+} // namespace probes_tests
@@ -1,14 +1,27 @@
 #pragma once
 
 #include "concepts.hpp"
+#include "contexts.hpp"
+#include "cuts.hpp"
 #include "either.hpp"
+#include "firsts.hpp"
+#include "inputs.hpp"
+#include "probes.hpp"
+#include "smalls.hpp"
+#include <concepts>
+#include <cstddef>
 #include <functional>
 #include <istream>
+#include <memory_resource>
 #include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 namespace tokenizes::repeats {
 using tokenizes::concepts::either_of;
 using tokenizes::concepts::has_push_back;
+using tokenizes::concepts::input_of;
 using tokenizes::concepts::left_of;
 using tokenizes::concepts::parsable;
 using tokenizes::concepts::right_of;
@@ -16,63 +29,102 @@ using tokenizes::eithers::either;
 using tokenizes::eithers::either_mode;
 using tokenizes::eithers::left;
 using tokenizes::eithers::right;
+
+// default for repeat_into: rewinds are not reported
+struct ignore_rewinding {
+    template <class Pos>
+    void operator()(const Pos &) const {}
+};
+
+/** drives a repetition: at least n, at most m items, each handed to sink as an rvalue
+ * a failure within the first n items rewinds to the start and is returned.
+ * a failure after that rewinds to the start of the failed item and ends the repetition,
+ * unless a cut inside the item committed it; then the failure is returned where it happened.
+ * rewinding is told about every rewind before it happens.
+ */
+template <parsable P, class S, class R = ignore_rewinding>
+    requires std::invocable<S &, right_of<P> &&>
+std::optional<left_of<P>> repeat_into(const P &parser, input_of<P> &is, size_t n, size_t m, S &sink,
+                                      R &&rewinding = {}) {
+    size_t i = 0;
+    // head
+    for (const auto head = inputs::tell(is); i < n; i++) {
+        const cuts::cut_point<input_of<P>, cuts::may_cut<P>> point(is, head);
+        either_of<P> item = parser(is);
+        switch (item.get_mode()) {
+        case either_mode::right:
+            sink(std::move(item.get_right()));
+            break;
+        case either_mode::left:
+            if (!point.committed()) {
+                rewinding(head);
+                inputs::rewind(is, head);
+            }
+            return std::move(item.get_left());
+        case either_mode::none:
+            throw std::range_error("none is unexpceted");
+        default:
+            throw std::range_error("others is unexpceted");
+        }
+    }
+
+    // tail
+    for (; i < m; i++) {
+        const auto tail = inputs::tell(is);
+        const cuts::cut_point<input_of<P>, cuts::may_cut<P>> point(is, tail);
+        either_of<P> item = parser(is);
+        if (!item.is_right()) {
+            if (point.committed() && item.is_left()) {
+                return std::move(item.get_left());
+            }
+            rewinding(tail);
+            inputs::rewind(is, tail);
+            break;
+        }
+        sink(std::move(item.get_right()));
+    }
+    return std::nullopt;
+}
+
 template <parsable P, has_push_back<right_of<P>> C>
     requires std::default_initializable<C>
 class repeat {
 public:
+    using input_t = input_of<P>;
     using right_t = C;
     using left_t = left_of<P>;
 
 private:
     P parser;
     size_t n, m;
+    [[no_unique_address]] probes::probe probe{"repeat"};
 
 public:
     repeat(const P &_parser, size_t _n = 0, size_t _m = SIZE_MAX) : parser(_parser), n(_n), m(_m) {}
-    either<C, left_t> operator()(std::istream &is) const {
-        size_t i = 0;
-        C items;
-        // head
-        for (const auto head = is.tellg(); i < n; i++) {
-            const either_of<P> item = parser(is);
-            switch (item.get_mode()) {
-            case either_mode::right:
-                items.push_back(item.get_right());
-                break;
-            case either_mode::left:
-                is.seekg(head);
-                return left<left_t>(item.get_left());
-            case either_mode::none:
-                throw std::range_error("none is unexpceted");
-            default:
-                throw std::range_error("others is unexpceted");
-            }
-        }
-
-        // tail
-        for (; i < m; i++) {
-            const auto tail = is.tellg();
-            const either_of<P> item = parser(is);
-            if (!item.is_right()) {
-                is.seekg(tail);
-                return right<C>(items);
-            }
-            items.push_back(item.get_right());
+    either<C, left_t> operator()(input_t &is) const {
+        probes::scope<probes::probe, input_t> call(probe, is);
+        C items = contexts::make_result<C>(is);
+        auto sink = [&items](right_of<P> &&item) { items.push_back(std::move(item)); };
+        auto rewinding = [&call](const auto &pos) { call.rewinding(pos); };
+        if (auto failure = repeat_into(parser, is, n, m, sink, rewinding); failure) {
+            return left(std::move(*failure));
         }
-        return right<C>(items);
+        call.succeeded();
+        return right(std::move(items));
     }
+    firsts::first_set first() const { return n == 0 ? firsts::any() : firsts::first_of(parser); }
 };
 
 // T -> vector<T>
 template <class P>
-repeat(P, size_t, size_t) -> repeat<P, std::vector<right_of<P>>>;
+repeat(P, size_t = 0, size_t = SIZE_MAX) -> repeat<P, std::vector<right_of<P>>>;
 
 template <class P>
 concept parsable_char = parsable<P> && std::same_as<right_of<P>, char>;
 
 // char -> std::string
 template <parsable_char P>
-repeat(P, size_t, size_t) -> repeat<P, std::string>;
+repeat(P, size_t = 0, size_t = SIZE_MAX) -> repeat<P, std::string>;
 
 template <class P>
 static inline auto many0(const P &p) {
@@ -94,14 +146,116 @@ static inline auto many1(const P &p) {
     return repeat<P, std::string>(p, 1);
 }
 
+/** T -> pmr::vector<T>, char -> pmr::string
+ * allocated from the memory resource attached to the input (see contexts::resource_scope).
+ */
+template <class T>
+using pmr_container = std::conditional_t<std::same_as<T, char>, std::pmr::string, std::pmr::vector<T>>;
+
 template <class P>
-static inline auto some(const P &p) {
-    return repeat(p, 0, 1);
+static inline auto pmr_many0(const P &p) {
+    return repeat<P, pmr_container<right_of<P>>>(p, 0);
 }
 
-template <parsable_char P>
+template <class P>
+static inline auto pmr_many1(const P &p) {
+    return repeat<P, pmr_container<right_of<P>>>(p, 1);
+}
+
+/** container for at most M items, known at compile time
+ * up to small_limit items are kept inline; larger bounds fall back to vector/string.
+ */
+constexpr static inline size_t small_limit = 16;
+
+template <class T, size_t M>
+using bounded_container =
+    std::conditional_t<(M <= small_limit),
+                       std::conditional_t<std::same_as<T, char>, smalls::small_string<M>, smalls::small_vector<T, M>>,
+                       std::conditional_t<std::same_as<T, char>, std::string, std::vector<T>>>;
+
+/** n..M items, without a heap allocation while M <= small_limit
+ * sequenced, the small containers merge into string and vector (see combinators::typed_merge).
+ */
+template <size_t M, parsable P>
+    requires(M > 0)
+static inline auto bounded(const P &p, size_t n = 0) {
+    return repeat<P, bounded_container<right_of<P>, M>>(p, n, M);
+}
+
+// zero or one item, kept inline: small_vector<T, 1> (small_string<1> for chars)
+template <parsable P>
 static inline auto some(const P &p) {
-    return repeat<P, std::string>(p, 0, 1);
+    return bounded<1>(p);
+}
+
+/** T -> acc = op(acc, T)
+ * items are reduced as they are parsed, so no container is built.
+ */
+template <parsable P, std::move_constructible T, class F>
+    requires std::is_invocable_r_v<T, const F &, T &&, right_of<P> &&>
+class fold {
+public:
+    using input_t = input_of<P>;
+    using right_t = T;
+    using left_t = left_of<P>;
+
+private:
+    P parser;
+    T init;
+    F op;
+    size_t n, m;
+
+public:
+    fold(const P &_parser, const T &_init, const F &_op, size_t _n = 0, size_t _m = SIZE_MAX)
+        : parser(_parser), init(_init), op(_op), n(_n), m(_m) {}
+    either<T, left_t> operator()(input_t &is) const {
+        T acc = contexts::copy_result(init, is);
+        auto sink = [this, &acc](right_of<P> &&item) { acc = op(std::move(acc), std::move(item)); };
+        if (auto failure = repeat_into(parser, is, n, m, sink); failure) {
+            return left(std::move(*failure));
+        }
+        return right(std::move(acc));
+    }
+    firsts::first_set first() const { return n == 0 ? firsts::any() : firsts::first_of(parser); }
+};
+
+/** T -> sink(T), nullptr
+ * the result is nullptr, which sequencer drops.
+ */
+template <parsable P, class F>
+    requires std::invocable<const F &, right_of<P> &&>
+class for_each {
+public:
+    using input_t = input_of<P>;
+    using right_t = std::nullptr_t;
+    using left_t = left_of<P>;
+
+private:
+    P parser;
+    F sink;
+    size_t n, m;
+
+public:
+    for_each(const P &_parser, const F &_sink, size_t _n = 0, size_t _m = SIZE_MAX)
+        : parser(_parser), sink(_sink), n(_n), m(_m) {}
+    either<std::nullptr_t, left_t> operator()(input_t &is) const {
+        if (auto failure = repeat_into(parser, is, n, m, sink); failure) {
+            return left(std::move(*failure));
+        }
+        return right(nullptr);
+    }
+    firsts::first_set first() const { return n == 0 ? firsts::any() : firsts::first_of(parser); }
+};
+
+struct discard {
+    template <class T>
+    void operator()(T &&) const {}
+};
+
+// T -> nullptr
+template <class P>
+static inline auto skip_many(const P &p, size_t n = 0, size_t m = SIZE_MAX) {
+    return for_each(p, discard(), n, m);
 }
 
 } // namespace tokenizes::repeats
\ No newline at end of file
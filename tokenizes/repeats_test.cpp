@@ -1,3 +1,4 @@
+#include "combinators.hpp"
 #include "primitive.hpp"
 #include "repeats.hpp"
 #include "gtest/gtest.h"
@@ -6,6 +7,7 @@
 using namespace tokenizes::primitive;
 using namespace tokenizes::repeats;
 using namespace std;
+using tokenizes::combinators::operator*;
 
 namespace repeat_digit_tests {
 
@@ -81,4 +83,124 @@ TEST(many1, digit_2) {
     EXPECT_EQ(parser(ss).opt_right(), "12");
 }
 
-} // namespace many0
\ No newline at end of file
+} // namespace many0
+namespace fold_tests {
+const static digit_parser number(10);
+const static auto sum = fold(number, 0, [](int acc, int x) { return acc + x; });
+
+TEST(fold, empty) {
+    stringstream ss;
+    ss << "x";
+    EXPECT_EQ(sum(ss).opt_right(), 0);
+    EXPECT_EQ(ss.get(), 'x');
+}
+
+TEST(fold, sum) {
+    stringstream ss;
+    ss << "123x";
+    EXPECT_EQ(sum(ss).opt_right(), 6);
+    EXPECT_EQ(ss.get(), 'x');
+}
+
+TEST(fold, least) {
+    const auto count = fold(digit, size_t(0), [](size_t acc, char) { return acc + 1; }, 2);
+    stringstream ss;
+    ss << "1x";
+    EXPECT_TRUE(count(ss).is_left());
+    EXPECT_EQ(ss.get(), '1');
+}
+
+} // namespace fold_tests
+
+namespace for_each_tests {
+
+TEST(for_each, sink) {
+    std::vector<char> items;
+    const auto parser = tokenizes::repeats::for_each(digit, [&items](char c) { items.push_back(c); });
+    stringstream ss;
+    ss << "12x";
+    EXPECT_EQ(parser(ss).opt_right(), nullptr);
+    EXPECT_EQ(items, std::vector<char>({'1', '2'}));
+}
+
+TEST(skip_many, digit) {
+    const auto parser = skip_many(digit);
+    stringstream ss;
+    ss << "123x";
+    EXPECT_TRUE(parser(ss).is_right());
+    EXPECT_EQ(ss.get(), 'x');
+}
+
+TEST(skip_many, least) {
+    const auto parser = skip_many(digit, 1);
+    stringstream ss;
+    ss << "x";
+    EXPECT_TRUE(parser(ss).is_left());
+}
+
+} // namespace for_each_tests
+
+namespace bounded_tests {
+
+TEST(some, inline) {
+    static_assert(std::same_as<decltype(some(digit))::right_t, tokenizes::smalls::small_string<1>>);
+    static_assert(std::same_as<decltype(some(digit_parser(10)))::right_t, tokenizes::smalls::small_vector<int, 1>>);
+    stringstream ss;
+    ss << "x";
+    const auto e = some(digit)(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right(), "");
+    EXPECT_TRUE(e.get_right().is_inline());
+}
+
+TEST(some, merged) {
+    const auto parser = some(sign) * many1(digit);
+    static_assert(std::same_as<decltype(parser)::right_t, std::string>);
+    stringstream ss;
+    ss << "-12";
+    EXPECT_EQ(parser(ss).opt_right(), "-12");
+}
+
+TEST(bounded, inline) {
+    const auto parser = bounded<1>(digit);
+    static_assert(std::same_as<decltype(parser)::right_t, tokenizes::smalls::small_string<1>>);
+    stringstream ss;
+    ss << "12";
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right(), "1");
+    EXPECT_TRUE(e.get_right().is_inline());
+}
+
+TEST(bounded, digit) {
+    const auto parser = bounded<4>(digit_parser(10), 2);
+    stringstream ss;
+    ss << "12345";
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right(), (tokenizes::smalls::small_vector<int, 4>{1, 2, 3, 4}));
+    EXPECT_EQ(ss.get(), '5');
+}
+
+TEST(bounded, merged) {
+    const auto text = bounded<1>(sign) * many1(digit) * bounded<2>(digit);
+    static_assert(std::same_as<decltype(text)::right_t, std::string>);
+    stringstream ss;
+    ss << "+123";
+    EXPECT_EQ(text(ss).opt_right(), "+123");
+
+    const auto numbers = bounded<2>(digit_parser(10)) * digit_parser(10);
+    static_assert(std::same_as<decltype(numbers)::right_t, std::vector<int>>);
+    stringstream ns;
+    ns << "123";
+    EXPECT_EQ(numbers(ns).opt_right(), (std::vector<int>{1, 2, 3}));
+
+    const auto pair = bounded<1>(digit) * bounded<1>(digit);
+    static_assert(std::same_as<decltype(pair)::right_t, std::string>);
+}
+
+TEST(bounded, large) {
+    static_assert(std::same_as<decltype(bounded<64>(digit))::right_t, std::string>);
+}
+
+} // namespace bounded_tests
@@ -0,0 +1,166 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+namespace tokenizes::smalls {
+
+/** vector with inline capacity
+ * the first N items live inside the object; pushing past that moves everything to the heap once.
+ * the results of some and of bounded<M> with M <= repeats::small_limit use it, and so do not allocate.
+ */
+template <class T, size_t N>
+    requires(N > 0)
+class small_vector {
+    alignas(T) std::byte storage[N * sizeof(T)];
+    T *items;
+    size_t count{0}, limit{N};
+
+    T *inline_items() { return std::launder(reinterpret_cast<T *>(storage)); }
+
+    void grow(size_t capacity) {
+        T *next = std::allocator<T>().allocate(capacity);
+        std::uninitialized_move(items, items + count, next);
+        std::destroy(items, items + count);
+        release();
+        items = next, limit = capacity;
+    }
+
+    void release() {
+        if (!is_inline()) {
+            std::allocator<T>().deallocate(items, limit);
+        }
+        items = inline_items(), limit = N;
+    }
+
+    void take(small_vector &&x) {
+        if (x.is_inline()) {
+            std::uninitialized_move(x.begin(), x.end(), items);
+            count = x.count;
+            x.clear();
+        } else {
+            // steal the heap buffer
+            items = std::exchange(x.items, x.inline_items());
+            count = std::exchange(x.count, 0);
+            limit = std::exchange(x.limit, N);
+        }
+    }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    small_vector() : items(inline_items()) {}
+    small_vector(std::initializer_list<T> init) : small_vector() {
+        reserve(init.size());
+        for (const T &item : init) {
+            push_back(item);
+        }
+    }
+    small_vector(const small_vector &x) : small_vector() {
+        reserve(x.count);
+        std::uninitialized_copy(x.begin(), x.end(), items);
+        count = x.count;
+    }
+    small_vector(small_vector &&x) : small_vector() { take(std::move(x)); }
+    ~small_vector() {
+        clear();
+        release();
+    }
+
+    small_vector &operator=(const small_vector &x) {
+        if (this != &x) {
+            small_vector copy(x);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+    small_vector &operator=(small_vector &&x) {
+        if (this != &x) {
+            clear();
+            release();
+            take(std::move(x));
+        }
+        return *this;
+    }
+
+    void push_back(const T &item) { emplace_back(item); }
+    void push_back(T &&item) { emplace_back(std::move(item)); }
+    template <class... A>
+    T &emplace_back(A &&...args) {
+        if (count == limit) {
+            grow(limit * 2);
+        }
+        T *item = std::construct_at(items + count, std::forward<A>(args)...);
+        count++;
+        return *item;
+    }
+    void pop_back() { std::destroy_at(items + --count); }
+    void reserve(size_t capacity) {
+        if (capacity > limit) {
+            grow(capacity);
+        }
+    }
+    void clear() {
+        std::destroy(items, items + count);
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return limit; }
+    bool empty() const { return count == 0; }
+    // no heap buffer is held
+    bool is_inline() const { return items == reinterpret_cast<const T *>(storage); }
+    constexpr static size_t inline_capacity() { return N; }
+
+    T *data() { return items; }
+    const T *data() const { return items; }
+    T *begin() { return items; }
+    T *end() { return items + count; }
+    const T *begin() const { return items; }
+    const T *end() const { return items + count; }
+    T &operator[](size_t i) { return items[i]; }
+    const T &operator[](size_t i) const { return items[i]; }
+    T &front() { return items[0]; }
+    T &back() { return items[count - 1]; }
+    const T &front() const { return items[0]; }
+    const T &back() const { return items[count - 1]; }
+
+    friend bool operator==(const small_vector &x, const small_vector &y) {
+        return std::equal(x.begin(), x.end(), y.begin(), y.end());
+    }
+};
+
+// small_vector of chars viewed as text
+template <size_t N>
+class small_string : public small_vector<char, N> {
+public:
+    using small_vector<char, N>::small_vector;
+    small_string() = default;
+    explicit small_string(std::string_view text) {
+        this->reserve(text.size());
+        for (const char c : text) {
+            this->push_back(c);
+        }
+    }
+
+    std::string_view view() const { return {this->data(), this->size()}; }
+    std::string str() const { return std::string(view()); }
+    operator std::string_view() const { return view(); }
+
+    friend bool operator==(const small_string &x, std::string_view y) { return x.view() == y; }
+    friend bool operator==(const small_string &x, const small_string &y) { return x.view() == y.view(); }
+};
+
+template <size_t N>
+std::ostream &operator<<(std::ostream &os, const small_string<N> &s) {
+    return os << s.view();
+}
+
+} // namespace tokenizes::smalls
@@ -0,0 +1,55 @@
+#include "smalls.hpp"
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+using namespace tokenizes::smalls;
+
+TEST(small_vector, inline) {
+    small_vector<int, 4> v;
+    for (int i = 0; i < 4; i++) {
+        v.push_back(i);
+    }
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(v.size(), 4);
+    EXPECT_EQ(v.back(), 3);
+}
+
+TEST(small_vector, spill) {
+    small_vector<std::string, 2> v{"a", "b"};
+    v.push_back("c");
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_EQ(v, (small_vector<std::string, 2>{"a", "b", "c"}));
+}
+
+TEST(small_vector, move) {
+    small_vector<std::unique_ptr<int>, 2> x;
+    x.push_back(std::make_unique<int>(1));
+    small_vector<std::unique_ptr<int>, 2> y = std::move(x);
+    EXPECT_TRUE(x.empty());
+    ASSERT_EQ(y.size(), 1);
+    EXPECT_EQ(*y[0], 1);
+
+    y.push_back(std::make_unique<int>(2));
+    y.push_back(std::make_unique<int>(3));
+    x = std::move(y);
+    EXPECT_FALSE(x.is_inline());
+    EXPECT_TRUE(y.is_inline());
+    EXPECT_EQ(*x[2], 3);
+}
+
+TEST(small_vector, copy) {
+    small_vector<int, 1> x{1, 2, 3};
+    small_vector<int, 1> y;
+    y = x;
+    EXPECT_EQ(x, y);
+    y.pop_back();
+    EXPECT_EQ(y.size(), 2);
+}
+
+TEST(small_string, view) {
+    small_string<4> s("abc");
+    s.push_back('d');
+    EXPECT_TRUE(s.is_inline());
+    EXPECT_EQ(s, "abcd");
+    EXPECT_EQ(s.str(), std::string("abcd"));
+}
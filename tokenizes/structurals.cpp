@@ -0,0 +1,245 @@
+#include "structurals.hpp"
+#include "primitive.hpp"
+#include <array>
+#include <bit>
+#include <cstring>
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+namespace tokenizes::structurals {
+
+using eithers::left;
+using eithers::right;
+using tokens::compact_token;
+using tokens::token_errors;
+using tokens::token_id;
+using lexer = tokens::token_parser::lexer;
+
+uint64_t prefix_xor(uint64_t bits) {
+#if defined(__PCLMUL__)
+    const __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(bits)), _mm_set1_epi8(-1), 0);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+#else
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+#endif
+}
+
+uint64_t escaped_by(uint64_t backslashes, uint64_t &carry) {
+    constexpr uint64_t odd = 0xaaaaaaaaaaaaaaaa;
+
+    // a backslash escaped by the previous block starts nothing
+    const uint64_t potential = backslashes & ~carry;
+    // subtracting each run from the odd bits flips the parity of what follows it
+    const uint64_t maybe_escaped = potential << 1;
+    const uint64_t codes = ((maybe_escaped | odd) - potential) ^ odd;
+    const uint64_t escaped = codes ^ (backslashes | carry);
+    carry = (codes & backslashes) >> 63;
+    return escaped;
+}
+
+namespace {
+
+struct block_bits {
+    uint64_t spaces{0}, words{0}, single_quotes{0}, double_quotes{0}, backslashes{0};
+};
+
+#if defined(__SSE2__)
+block_bits classify(const char *p) {
+    const auto eq = [](__m128i v, char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); };
+    // lo <= v <= hi, unsigned
+    const auto in_range = [](__m128i v, char lo, char hi) {
+        const __m128i offset = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+        return _mm_cmpeq_epi8(_mm_subs_epu8(offset, _mm_set1_epi8(static_cast<char>(hi - lo))), _mm_setzero_si128());
+    };
+    const auto bits = [](__m128i m, int k) {
+        return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(m))) << (16 * k);
+    };
+
+    block_bits b;
+    for (int k = 0; k < 4; k++) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * k));
+        const __m128i spaces = _mm_or_si128(_mm_or_si128(eq(v, ' '), eq(v, '\t')), _mm_or_si128(eq(v, '\r'), eq(v, '\n')));
+        const __m128i letters = in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+        const __m128i words = _mm_or_si128(_mm_or_si128(letters, in_range(v, '0', '9')), eq(v, '_'));
+        b.spaces |= bits(spaces, k);
+        b.words |= bits(words, k);
+        b.single_quotes |= bits(eq(v, '\''), k);
+        b.double_quotes |= bits(eq(v, '"'), k);
+        b.backslashes |= bits(eq(v, '\\'), k);
+    }
+    return b;
+}
+#else
+enum byte_class : uint8_t { space = 1, word = 2, single_quote = 4, double_quote = 8, backslash = 16 };
+
+const std::array<uint8_t, 256> byte_classes = []() {
+    std::array<uint8_t, 256> table{};
+    for (const char c : std::string_view(" \t\r\n")) {
+        table[static_cast<unsigned char>(c)] = space;
+    }
+    for (unsigned c = 0; c < 256; c++) {
+        if (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_') {
+            table[c] = word;
+        }
+    }
+    table['\''] = single_quote, table['"'] = double_quote, table['\\'] = backslash;
+    return table;
+}();
+
+block_bits classify(const char *p) {
+    block_bits b;
+    for (int i = 0; i < 64; i++) {
+        const uint8_t c = byte_classes[static_cast<unsigned char>(p[i])];
+        const uint64_t bit = uint64_t(1) << i;
+        b.spaces |= c & space ? bit : 0;
+        b.words |= c & word ? bit : 0;
+        b.single_quotes |= c & single_quote ? bit : 0;
+        b.double_quotes |= c & double_quote ? bit : 0;
+        b.backslashes |= c & backslash ? bit : 0;
+    }
+    return b;
+}
+#endif
+
+// bytes inside texts; quote is the quote of the text still open at the block end, or 0
+uint64_t strings_of(uint64_t single_quotes, uint64_t double_quotes, char &quote) {
+    const uint64_t open = quote ? ~uint64_t(0) : 0;
+    if (!double_quotes && quote != '"') {
+        const uint64_t inside = prefix_xor(single_quotes) ^ open;
+        quote = inside >> 63 ? '\'' : 0;
+        return inside;
+    }
+    if (!single_quotes && quote != '\'') {
+        const uint64_t inside = prefix_xor(double_quotes) ^ open;
+        quote = inside >> 63 ? '"' : 0;
+        return inside;
+    }
+
+    // mixed quotes: a quote of the other kind inside a text is an ordinary byte
+    uint64_t inside = 0;
+    size_t from = 0;
+    for (uint64_t quotes = single_quotes | double_quotes; quotes; quotes &= quotes - 1) {
+        const size_t i = std::countr_zero(quotes);
+        const char kind = single_quotes >> i & 1 ? '\'' : '"';
+        if (!quote) {
+            quote = kind, from = i;
+        } else if (quote == kind) {
+            inside |= (~uint64_t(0) << from) & ~(~uint64_t(0) << i);
+            quote = 0;
+        }
+    }
+    if (quote) {
+        inside |= ~uint64_t(0) << from;
+    }
+    return inside;
+}
+
+// first position at or after i whose bit is clear, or the bit capacity
+size_t next_clear(const std::vector<uint64_t> &bits, size_t i) {
+    for (size_t w = i / 64; w < bits.size(); w++) {
+        const uint64_t clear = ~bits[w] & (w == i / 64 ? ~uint64_t(0) << (i % 64) : ~uint64_t(0));
+        if (clear) {
+            return w * 64 + std::countr_zero(clear);
+        }
+    }
+    return bits.size() * 64;
+}
+
+} // namespace
+
+structural_index index_of(std::string_view source) {
+    structural_index index;
+    const size_t blocks = source.size() / 64 + 1;
+    index.size = source.size();
+    index.spaces.resize(blocks), index.words.resize(blocks);
+    index.strings.resize(blocks), index.escaped.resize(blocks);
+
+    uint64_t carry = 0;
+    char quote = 0;
+    for (size_t w = 0; w < blocks; w++) {
+        const size_t begin = w * 64;
+        block_bits b;
+        if (begin + 64 <= source.size()) {
+            b = classify(source.data() + begin);
+        } else {
+            // the last block is padded with nul, which belongs to no class
+            char padded[64] = {};
+            std::memcpy(padded, source.data() + begin, source.size() - begin);
+            b = classify(padded);
+        }
+
+        const uint64_t escaped = escaped_by(b.backslashes, carry);
+        index.spaces[w] = b.spaces, index.words[w] = b.words, index.escaped[w] = escaped;
+        index.strings[w] = strings_of(b.single_quotes & ~escaped, b.double_quotes & ~escaped, quote);
+    }
+    return index;
+}
+
+either<tokens::lazy_tokens, std::string> structural_lexer::tokenize(std::string_view source) const {
+    if (source.size() > UINT32_MAX) {
+        return left(std::string("source does not fit 32 bit offsets"));
+    }
+
+    const structural_index index = index_of(source);
+    const auto &lexers = tokens::token_parser::get_lexers();
+    const size_t n = source.size();
+    const auto emit = [](token_id id, size_t begin, size_t end) {
+        return compact_token{id, static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin), 0};
+    };
+
+    tokens::lazy_tokens tokens(source, table);
+    tokens.reserve(n / 8);
+    bool operand = false; // the last token ends an operand
+    for (size_t offset = next_clear(index.spaces, 0); offset < n; offset = next_clear(index.spaces, offset)) {
+        switch (lexers[static_cast<unsigned char>(source[offset])]) {
+        case lexer::identifier: {
+            const size_t end = std::min(next_clear(index.words, offset + 1), n);
+            const std::string_view name = source.substr(offset, end - offset);
+            tokens.push_back(emit(name == "true" || name == "false" ? token_id::boolean : token_id::variable, offset, end));
+            operand = true;
+            offset = end;
+            break;
+        }
+        case lexer::text: {
+            // the closing quote is the first byte after the opening one outside the text
+            const size_t close = next_clear(index.strings, offset + 1);
+            if (close >= n) {
+                return left(std::string(tokens::message_of(token_errors::bad_text)));
+            }
+            for (size_t w = offset / 64; w <= close / 64; w++) {
+                for (uint64_t escaped = index.escaped[w]; escaped; escaped &= escaped - 1) {
+                    const size_t i = w * 64 + std::countr_zero(escaped);
+                    if (offset < i && i < close && !primitive::escape_of(source[i])) {
+                        return left(std::string(tokens::message_of(token_errors::bad_text)));
+                    }
+                }
+            }
+            tokens.push_back(emit(token_id::text, offset, close + 1));
+            operand = true;
+            offset = close + 1;
+            break;
+        }
+        default: {
+            auto e = lexer.next(source, offset, false, operand);
+            if (e.is_left()) {
+                return left(std::string(tokens::message_of(e.get_left())));
+            }
+            operand = tokens::ends_operand(e.get_right().id);
+            tokens.push_back(e.get_right());
+            break;
+        }
+        }
+    }
+    return right(std::move(tokens));
+}
+
+} // namespace tokenizes::structurals
@@ -0,0 +1,50 @@
+#pragma once
+#include "either.hpp"
+#include "lazies.hpp"
+#include "symbols.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace tokenizes::structurals {
+
+using tokenizes::eithers::either;
+
+// bit i is the parity of bits 0..i (carry-less multiply by all ones under __PCLMUL__)
+uint64_t prefix_xor(uint64_t bits);
+
+// bytes preceded by an odd run of backslashes; carry is 1 when the previous block ended inside such a run
+uint64_t escaped_by(uint64_t backslashes, uint64_t &carry);
+
+/** stage 1: one bit per source byte, 64 bytes per word
+ * bytes are classified 16 at a time under SSE2 (a lookup table otherwise).
+ * strings marks text literals from the opening quote up to, not including, the closing one;
+ * a block holding a single kind of quote is resolved with prefix_xor, mixed quotes by walking the quote bits.
+ */
+struct structural_index {
+    std::vector<uint64_t> spaces, words, strings, escaped;
+    size_t size{0};
+};
+
+structural_index index_of(std::string_view source);
+
+/** two-stage lexer over contiguous text
+ * stage 2 jumps over spaces, identifiers and texts with bit scans over the index,
+ * and hands numbers and marks, which are short, to span_lexer.
+ * tokens and errors are identical to span_lexer's, and so to token_parser's.
+ */
+class structural_lexer {
+    std::shared_ptr<symbols::symbol_table> table;
+    tokens::span_lexer lexer;
+
+public:
+    structural_lexer() : structural_lexer(std::make_shared<symbols::symbol_table>()) {}
+    structural_lexer(std::shared_ptr<symbols::symbol_table> _table) : table(std::move(_table)), lexer(table) {}
+
+    either<tokens::lazy_tokens, std::string> tokenize(std::string_view source) const;
+    symbols::symbol_table &get_symbols() const { return *table; }
+};
+
+} // namespace tokenizes::structurals
@@ -0,0 +1,118 @@
+#include "lazies.hpp"
+#include "structurals.hpp"
+#include "tokens.hpp"
+
+#include "gtest/gtest.h"
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace tokenizes::structurals;
+using tokenizes::tokens::span_lexer;
+using tokenizes::tokens::token_parser;
+
+namespace structurals_tests {
+
+TEST(prefix_xor, parity) {
+    EXPECT_EQ(prefix_xor(0), 0);
+    EXPECT_EQ(prefix_xor(1), ~uint64_t(0));
+    EXPECT_EQ(prefix_xor(0b1001), 0b0111);
+    EXPECT_EQ(prefix_xor(uint64_t(1) << 63), uint64_t(1) << 63);
+}
+
+TEST(escaped_by, same_as_scalar) {
+    std::mt19937 random(1);
+    for (int round = 0; round < 200; round++) {
+        std::vector<uint64_t> blocks(4);
+        for (auto &b : blocks) {
+            // long runs of backslashes, crossing block ends
+            b = random() % 3 ? (uint64_t(random()) << 32 | random()) & (uint64_t(random()) << 32 | random()) : ~uint64_t(0);
+        }
+
+        uint64_t carry = 0;
+        bool pending = false;
+        for (const uint64_t b : blocks) {
+            uint64_t expected = 0;
+            for (int i = 0; i < 64; i++) {
+                if (pending) {
+                    expected |= uint64_t(1) << i, pending = false;
+                } else if (b >> i & 1) {
+                    pending = true;
+                }
+            }
+            ASSERT_EQ(escaped_by(b, carry), expected) << round;
+        }
+    }
+}
+
+TEST(index_of, strings) {
+    const std::string source = "a 'b \"c' \"d 'e\\\" f\" 'g\\\\' h";
+    const structural_index index = index_of(source);
+    std::string inside;
+    for (size_t i = 0; i < source.size(); i++) {
+        inside.push_back(index.strings[i / 64] >> (i % 64) & 1 ? 's' : '.');
+    }
+    EXPECT_EQ(inside, "..sssss..sssssssss..ssss...");
+}
+
+static void expect_same(const std::string &source) {
+    const auto expected = span_lexer().tokenize(source);
+    const auto actual = structural_lexer().tokenize(source);
+    ASSERT_EQ(actual.is_right(), expected.is_right()) << source;
+    if (expected.is_left()) {
+        EXPECT_EQ(actual.get_left(), expected.get_left()) << source;
+        return;
+    }
+    const auto x = expected.get_right().get_tokens(), y = actual.get_right().get_tokens();
+    ASSERT_EQ(y.size(), x.size()) << source;
+    for (size_t i = 0; i < x.size(); i++) {
+        EXPECT_EQ(y[i].id, x[i].id) << source;
+        EXPECT_EQ(y[i].offset, x[i].offset) << source;
+        EXPECT_EQ(y[i].length, x[i].length) << source;
+    }
+}
+
+TEST(structural_lexer, same_as_span_lexer) {
+    const char *const parts[] = {"x",        "count_2", "true",    "false", "=",      "+",         "-",
+                                 "*",        "/",       "%",       "(",     ")",      "42",        "-7",
+                                 "0x1F",     "0b101",   "3.25",    "1.5e-3", "'t'",   "\"q\"",     "'a\\nb'",
+                                 "'it\\'s'", "\"'\"",   "'\"'",    "'\\\\'", " ",     "\n",        "\t",
+                                 "'a long text that certainly crosses the end of a 64 byte block, and then some'"};
+    std::mt19937 random(7);
+    for (int round = 0; round < 300; round++) {
+        std::string source;
+        const size_t count = random() % 60;
+        for (size_t i = 0; i < count; i++) {
+            source += parts[random() % std::size(parts)];
+            source += random() % 4 ? " " : "";
+        }
+        expect_same(source);
+    }
+}
+
+TEST(structural_lexer, errors) {
+    for (const std::string source : {"a $", "'open", "'bad \\q escape'", "\\'x'", "1.", "99999999999", "x = 'a\\",
+                                     "\"mixed ' quotes", "'"}) {
+        expect_same(source);
+    }
+}
+
+TEST(token_parser, contiguous) {
+    const token_parser parser;
+    const std::string text = "total = count * 3 + 'x\\ty' - offset_2 / 4.5 % -0x10 true";
+    std::stringstream ss(text);
+    const auto expected = parser.tokenize(ss);
+    const auto actual = parser.tokenize(std::string_view(text));
+    ASSERT_TRUE(expected.is_right());
+    ASSERT_TRUE(actual.is_right());
+    ASSERT_EQ(actual.get_right().size(), expected.get_right().size());
+    for (size_t i = 0; i < expected.get_right().size(); i++) {
+        EXPECT_EQ(actual.get_right()[i].id, expected.get_right()[i].id);
+        EXPECT_EQ(actual.get_right()[i].value, expected.get_right()[i].value);
+        EXPECT_EQ(actual.get_right()[i].pos.begin, expected.get_right()[i].pos.begin);
+        EXPECT_EQ(actual.get_right()[i].pos.end, expected.get_right()[i].pos.end);
+    }
+}
+
+} // namespace structurals_tests
@@ -0,0 +1,171 @@
+#include "symbols.hpp"
+#include "primitive.hpp"
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+namespace tokenizes::symbols {
+
+using tokenizes::eithers::left;
+using tokenizes::eithers::right;
+
+std::ostream &operator<<(std::ostream &os, symbol s) { return os << "symbol(" << s.id << ")"; }
+
+symbol_table::slots::slots(size_t capacity) : mask(capacity - 1), items(new std::atomic<uint64_t>[capacity]) {
+    for (size_t i = 0; i < capacity; i++) {
+        items[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+symbol_table::symbol_table(size_t capacity) {
+    for (auto &segment : segments) {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+    tables.push_back(std::make_unique<slots>(std::bit_ceil(std::max<size_t>(capacity, 16))));
+    current.store(tables.back().get(), std::memory_order_release);
+}
+
+// fnv-1a, folded to 32 bits
+uint64_t symbol_table::hash(std::string_view name) {
+    uint64_t h = 0xcbf29ce484222325;
+    for (const char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3;
+    }
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+std::tuple<size_t, size_t> symbol_table::locate(uint32_t id) {
+    const uint64_t index = static_cast<uint64_t>(id) + segment_base;
+    const size_t segment = std::bit_width(index) - 1 - segment_bits;
+    return {segment, index - (segment_base << segment)};
+}
+
+std::string_view symbol_table::store(std::string_view name) {
+    if (name.size() > chunk_size) {
+        chunks.push_back(std::make_unique<char[]>(name.size()));
+        std::memcpy(chunks.back().get(), name.data(), name.size());
+        return {chunks.back().get(), name.size()};
+    }
+    if (chunk_used + name.size() > chunk_size) {
+        chunks.push_back(std::make_unique<char[]>(chunk_size));
+        chunk_used = 0;
+    }
+    char *head = chunks.back().get() + chunk_used;
+    std::memcpy(head, name.data(), name.size());
+    chunk_used += name.size();
+    return {head, name.size()};
+}
+
+void symbol_table::grow() {
+    const slots &old = *current.load(std::memory_order_relaxed);
+    auto next = std::make_unique<slots>((old.mask + 1) * 2);
+    for (size_t i = 0; i <= old.mask; i++) {
+        const uint64_t item = old.items[i].load(std::memory_order_relaxed);
+        if (!item) continue;
+
+        size_t j = (item >> 32) & next->mask;
+        while (next->items[j].load(std::memory_order_relaxed)) {
+            j = (j + 1) & next->mask;
+        }
+        next->items[j].store(item, std::memory_order_relaxed);
+    }
+
+    // readers may still probe the old slots, so they are retired with the table
+    current.store(next.get(), std::memory_order_release);
+    tables.push_back(std::move(next));
+}
+
+std::optional<symbol> symbol_table::probe(const slots &table, uint64_t h, std::string_view name) const {
+    for (size_t i = h & table.mask;; i = (i + 1) & table.mask) {
+        const uint64_t item = table.items[i].load(std::memory_order_acquire);
+        if (!item) {
+            return std::nullopt;
+        }
+        if ((item >> 32) == h) {
+            const symbol s(static_cast<uint32_t>(item) - 1);
+            if (entry(s.id) == name) {
+                return s;
+            }
+        }
+    }
+}
+
+symbol symbol_table::intern(std::string_view name) {
+    if (const auto s = find(name); s) {
+        return *s;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint64_t h = hash(name);
+    if (const auto s = probe(*current.load(std::memory_order_relaxed), h, name); s) {
+        return *s;
+    }
+
+    const uint32_t id = count.load(std::memory_order_relaxed);
+    if (id == UINT32_MAX) {
+        throw std::length_error("symbol table is full");
+    }
+
+    // name
+    const auto [segment, offset] = locate(id);
+    std::string_view *names = segments[segment].load(std::memory_order_relaxed);
+    if (!names) {
+        segment_owners.push_back(std::make_unique<std::string_view[]>(segment_base << segment));
+        names = segment_owners.back().get();
+        segments[segment].store(names, std::memory_order_release);
+    }
+    names[offset] = store(name);
+
+    // slot
+    if ((static_cast<size_t>(id) + 1) * 2 > current.load(std::memory_order_relaxed)->mask + 1) {
+        grow();
+    }
+    const slots &table = *current.load(std::memory_order_relaxed);
+    size_t i = h & table.mask;
+    while (table.items[i].load(std::memory_order_relaxed)) {
+        i = (i + 1) & table.mask;
+    }
+    table.items[i].store(h << 32 | (static_cast<uint64_t>(id) + 1), std::memory_order_release);
+    count.store(id + 1, std::memory_order_release);
+    return symbol(id);
+}
+
+std::optional<symbol> symbol_table::find(std::string_view name) const {
+    return probe(*current.load(std::memory_order_acquire), hash(name), name);
+}
+
+std::string_view symbol_table::entry(uint32_t id) const {
+    const auto [segment, offset] = locate(id);
+    return segments[segment].load(std::memory_order_acquire)[offset];
+}
+
+std::string_view symbol_table::name(symbol s) const {
+    if (s.id >= size()) {
+        throw std::out_of_range("unknown symbol");
+    }
+    return entry(s.id);
+}
+
+either<symbol, identifier_errors> identifier_parser::operator()(std::istream &is) const {
+    std::string buffer;
+    return (*this)(is, buffer);
+}
+
+either<symbol, identifier_errors> identifier_parser::operator()(std::istream &is, std::string &buffer) const {
+    const static primitive::atom head = primitive::alpha + primitive::atom('_');
+    const static primitive::atom tail = primitive::alnum + primitive::atom('_');
+
+    if (const int c = is.peek(); c == -1 || !head.get_chars().test(c)) {
+        return left(identifier_errors::not_begin);
+    }
+
+    buffer.clear();
+    for (int c = is.peek(); c != -1 && tail.get_chars().test(c); c = is.peek()) {
+        buffer.push_back(static_cast<char>(c));
+        is.ignore();
+    }
+    return right(table->intern(buffer));
+}
+
+} // namespace tokenizes::symbols
\ No newline at end of file
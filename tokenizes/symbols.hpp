@@ -0,0 +1,90 @@
+#pragma once
+#include "either.hpp"
+#include <array>
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+namespace tokenizes::symbols {
+
+using tokenizes::eithers::either;
+
+struct symbol {
+    uint32_t id;
+    constexpr explicit symbol(uint32_t _id = 0) : id(_id) {}
+    constexpr auto operator<=>(const symbol &) const = default;
+};
+
+std::ostream &operator<<(std::ostream &, symbol);
+
+/** interning table
+ * names are copied once into an append-only arena and identified by a 32-bit id.
+ * slots are open-addressed (linear probing) and packed as (hash << 32 | id + 1).
+ * find() and name() take no lock, so they may run concurrently with intern().
+ */
+class symbol_table {
+    struct slots {
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> items;
+        slots(size_t capacity);
+    };
+
+    // id -> name, segment k holds (segment_base << k) names so that pointers stay stable
+    constexpr static size_t segment_bits = 10;
+    constexpr static size_t segment_base = size_t(1) << segment_bits;
+    constexpr static size_t segment_count = 32 - segment_bits + 1;
+    constexpr static size_t chunk_size = 64 * 1024;
+
+    std::array<std::atomic<std::string_view *>, segment_count> segments;
+    std::atomic<slots *> current;
+    std::atomic<uint32_t> count{0};
+
+    // writer side, guarded by mutex
+    std::mutex mutex;
+    std::vector<std::unique_ptr<slots>> tables;
+    std::vector<std::unique_ptr<std::string_view[]>> segment_owners;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t chunk_used{chunk_size};
+
+    static uint64_t hash(std::string_view name);
+    static std::tuple<size_t, size_t> locate(uint32_t id);
+
+    std::string_view store(std::string_view name);
+    std::string_view entry(uint32_t id) const;
+    void grow();
+    std::optional<symbol> probe(const slots &table, uint64_t h, std::string_view name) const;
+
+public:
+    symbol_table(size_t capacity = 1024);
+    symbol_table(const symbol_table &) = delete;
+    symbol_table &operator=(const symbol_table &) = delete;
+
+    symbol intern(std::string_view name);
+    std::optional<symbol> find(std::string_view name) const;
+    std::string_view name(symbol s) const;
+    size_t size() const { return count.load(std::memory_order_acquire); }
+};
+
+enum class identifier_errors { not_begin };
+
+// [A-Za-z_][A-Za-z0-9_]*
+class identifier_parser {
+    symbol_table *table;
+
+public:
+    identifier_parser(symbol_table &_table) : table(&_table) {}
+    either<symbol, identifier_errors> operator()(std::istream &is) const;
+    // reads the name into buffer, whose capacity is kept across calls
+    either<symbol, identifier_errors> operator()(std::istream &is, std::string &buffer) const;
+    symbol_table &get_table() const { return *table; }
+};
+
+} // namespace tokenizes::symbols
\ No newline at end of file
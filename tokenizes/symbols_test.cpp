@@ -0,0 +1,88 @@
+#include "symbols.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tokenizes::symbols;
+
+namespace symbol_table_tests {
+
+TEST(symbol_table, intern_same) {
+    symbol_table table;
+    EXPECT_EQ(table.intern("x"), table.intern("x"));
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST(symbol_table, intern_distinct) {
+    symbol_table table;
+    const symbol x = table.intern("x");
+    const symbol y = table.intern("y");
+    EXPECT_NE(x, y);
+    EXPECT_EQ(table.name(x), "x");
+    EXPECT_EQ(table.name(y), "y");
+}
+
+TEST(symbol_table, find) {
+    symbol_table table;
+    const symbol x = table.intern("x");
+    EXPECT_EQ(table.find("x"), x);
+    EXPECT_EQ(table.find("y"), std::nullopt);
+}
+
+TEST(symbol_table, grow) {
+    symbol_table table(16);
+    for (int i = 0; i < 5000; i++) {
+        EXPECT_EQ(table.intern("name" + std::to_string(i)).id, i);
+    }
+    for (int i = 0; i < 5000; i++) {
+        const std::string name = "name" + std::to_string(i);
+        EXPECT_EQ(table.find(name), symbol(i));
+        EXPECT_EQ(table.name(symbol(i)), name);
+    }
+}
+
+TEST(symbol_table, concurrent) {
+    symbol_table table;
+    const symbol shared = table.intern("shared");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&table, shared, t]() {
+            for (int i = 0; i < 1000; i++) {
+                EXPECT_EQ(table.find("shared"), shared);
+                table.intern("name" + std::to_string(i * 4 + t));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(table.size(), 4001);
+}
+
+} // namespace symbol_table_tests
+
+namespace identifier_parser_tests {
+
+TEST(identifier_parser, success) {
+    symbol_table table;
+    const identifier_parser parser(table);
+    std::stringstream ss;
+    ss << "_abc1 ";
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(table.name(e.get_right()), "_abc1");
+    EXPECT_EQ(ss.peek(), ' ');
+}
+
+TEST(identifier_parser, not_begin) {
+    symbol_table table;
+    const identifier_parser parser(table);
+    std::stringstream ss;
+    ss << "1abc";
+    EXPECT_EQ(parser(ss).opt_left(), identifier_errors::not_begin);
+}
+
+} // namespace identifier_parser_tests
@@ -1,8 +1,12 @@
 #include "tokens.hpp"
 #include "combinators.hpp"
 #include "parsers.hpp"
+#include "structurals.hpp"
 #include <algorithm>
+#include <bit>
 #include <iomanip>
+#include <iterator>
+#include <stdexcept>
 #include <unordered_map>
 #include <vector>
 namespace tokenizes::tokens {
@@ -16,7 +20,7 @@ struct general_record {
     const char *name;
 };
 
-constinit const static general_record general_records[]{
+constexpr static general_record general_records[]{
 #define member(x) {token_id::x, #x}
     member(variable), member(boolean), member(integer), member(real), member(text)
 #undef member
@@ -28,9 +32,10 @@ struct mark_record {
     const char *mark;
 };
 
-constinit const static mark_record mark_records[]{
+constexpr static mark_record mark_records[]{
 #define member(x, y) {token_id::x, #x, y}
-    member(assign, "="), member(add, "+"), member(sub, "-"), member(mul, "*"), member(div, "*"), member(mod, "%"),
+    member(assign, "="), member(add, "+"), member(sub, "-"), member(mul, "*"), member(div, "/"), member(mod, "%"),
+    member(lparen, "("), member(rparen, ")"),
 #undef member
 };
 
@@ -59,6 +64,27 @@ std::ostream &operator<<(std::ostream &os, token_id id) {
     return os << name << "(0x" << std::hex << static_cast<int>(id) << ")";
 }
 
+std::string_view mark_of(token_id id) {
+    for (const auto &item : mark_records) {
+        if (item.id == id) {
+            return item.mark;
+        }
+    }
+    return {};
+}
+
+std::optional<std::tuple<token_id, size_t>> match_mark(std::string_view text) {
+    std::optional<std::tuple<token_id, size_t>> longest;
+    size_t size = 0;
+    for (const auto &item : mark_records) {
+        const std::string_view mark(item.mark);
+        if (mark.size() > size && text.starts_with(mark)) {
+            longest = {item.id, mark.size()}, size = mark.size();
+        }
+    }
+    return longest;
+}
+
 std::ostream &operator<<(std::ostream &os, const value_t &v) {
     if (const bool *p = std::get_if<bool>(&v); p) {
         return os << (*p ? "true" : "false");
@@ -69,45 +95,431 @@ std::ostream &operator<<(std::ostream &os, const value_t &v) {
     if (const float *p = std::get_if<float>(&v); p) {
         return os << *p;
     }
-    if (const std::string *p = std::get_if<std::string>(&v); p) {
+    if (const text_t *p = std::get_if<text_t>(&v); p) {
         return os << std::quoted(*p);
     }
+    if (const symbol *p = std::get_if<symbol>(&v); p) {
+        return os << *p;
+    }
     return os << "none";
 }
 
+std::ostream &operator<<(std::ostream &os, token_errors e) {
+    switch (e) {
+    case token_errors::end_of_input:
+        return os << "end_of_input";
+    case token_errors::unexpected_character:
+        return os << "unexpected_character";
+    case token_errors::bad_mark:
+        return os << "bad_mark";
+    case token_errors::bad_integer:
+        return os << "bad_integer";
+    case token_errors::bad_real:
+        return os << "bad_real";
+    case token_errors::bad_identifier:
+        return os << "bad_identifier";
+    case token_errors::bad_text:
+        return os << "bad_text";
+    default:
+        return os << "unknown";
+    }
+}
+
+std::string_view message_of(token_errors e) {
+    switch (e) {
+    case token_errors::end_of_input:
+        return "end of input";
+    case token_errors::unexpected_character:
+        return "unexpected character";
+    case token_errors::bad_mark:
+        return "failed to parse marks";
+    case token_errors::bad_integer:
+        return "failed to parse integer";
+    case token_errors::bad_real:
+        return "failed to parse real";
+    case token_errors::bad_identifier:
+        return "failed to parse variable";
+    case token_errors::bad_text:
+        return "failed to parse text";
+    default:
+        return "unknown error";
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, const diagnostic &d) { return os << d.kind << "@" << d.offset; }
+
+value_t value_with(value_t &&value, const std::pmr::polymorphic_allocator<> &alloc) {
+    if (text_t *p = std::get_if<text_t>(&value); p) {
+        return text_t(std::move(*p), alloc);
+    }
+    return std::move(value);
+}
+
 std::ostream &operator<<(std::ostream &os, const token &t) { return os << "id:" << t.id << ",value:" << t.value; }
 
-token_parser::token_parser() {}
+void token_buffer::reserve(size_t n) {
+    ids.reserve(n), offsets.reserve(n), lengths.reserve(n), payloads.reserve(n);
+}
+
+void token_buffer::push_back(const token &t) { push_back(token(t)); }
+
+void token_buffer::push_back(token &&t) {
+    if (t.pos.end > UINT32_MAX) {
+        throw std::length_error("token offset does not fit 32 bits");
+    }
+
+    uint32_t payload = 0;
+    if (const bool *p = std::get_if<bool>(&t.value); p) {
+        payload = *p;
+    } else if (const int *p = std::get_if<int>(&t.value); p) {
+        payload = std::bit_cast<uint32_t>(*p);
+    } else if (const float *p = std::get_if<float>(&t.value); p) {
+        payload = std::bit_cast<uint32_t>(*p);
+    } else if (const symbol *p = std::get_if<symbol>(&t.value); p) {
+        payload = p->id;
+    } else if (const text_t *p = std::get_if<text_t>(&t.value); p) {
+        payload = static_cast<uint32_t>(texts.size());
+        texts.emplace_back(*p);
+    }
+
+    ids.push_back(t.id);
+    offsets.push_back(static_cast<uint32_t>(t.pos.begin));
+    lengths.push_back(static_cast<uint32_t>(t.pos.size()));
+    payloads.push_back(payload);
+}
+
+void token_buffer::clear() {
+    ids.clear(), offsets.clear(), lengths.clear(), payloads.clear(), texts.clear();
+}
 
-either<token, std::string> token_parser::operator()(std::istream &is) {
+value_t token_buffer::value(size_t i) const {
+    const uint32_t payload = payloads[i];
+    switch (ids[i]) {
+    case token_id::variable:
+        return symbol(payload);
+    case token_id::boolean:
+        return payload != 0;
+    case token_id::integer:
+        return std::bit_cast<int>(payload);
+    case token_id::real:
+        return std::bit_cast<float>(payload);
+    case token_id::text:
+        return text_t(texts[payload]);
+    default:
+        return std::monostate();
+    }
+}
 
-    const static auto marks =
-        tokenizes::tag_mapper<token_id>([]() -> std::vector<std::tuple<std::string_view, token_id>> {
-            std::vector<std::tuple<std::string_view, token_id>> table;
-            table.reserve(sizeof(mark_records) / sizeof(mark_records[0]));
-            for (const auto &item : mark_records) {
-                table.push_back({item.mark, item.id});
+token token_buffer::at(size_t i) const {
+    if (i >= size()) {
+        throw std::out_of_range("token index out of range");
+    }
+    return token(ids[i], value(i), position(offsets[i], offsets[i] + lengths[i]));
+}
+
+either<token, std::nullptr_t> token_tag::operator()(token_input &in) const {
+    const token *t = in.peek();
+    if (!t || t->id != id) {
+        return left(nullptr);
+    }
+    in.get();
+    return right(*t);
+}
+
+const token_parser::mark_parser token_parser::marks = []() {
+    std::vector<std::tuple<std::string_view, token_id>> table;
+    table.reserve(std::size(mark_records));
+    for (const auto &item : mark_records) {
+        table.push_back({item.mark, item.id});
+    }
+    return mark_parser(mappers::tag_mapper<token_id>(table));
+}();
+
+const token_parser::lexer_table token_parser::lexers = []() {
+    lexer_table table;
+    table.fill(lexer::none);
+
+    for (const char c : std::string_view(" \t\r\n")) {
+        table[static_cast<unsigned char>(c)] = lexer::space;
+    }
+    for (const auto &item : mark_records) {
+        table[static_cast<unsigned char>(item.mark[0])] = lexer::mark;
+    }
+    // marks vs signed integers are resolved by maximal munch
+    table['+'] = table['-'] = lexer::sign;
+    for (unsigned c = '0'; c <= '9'; c++) {
+        table[c] = lexer::number;
+    }
+    for (unsigned c = 'a'; c <= 'z'; c++) {
+        table[c] = table[c - 'a' + 'A'] = lexer::identifier;
+    }
+    table['_'] = lexer::identifier;
+    table['\''] = table['"'] = lexer::text;
+    return table;
+}();
+
+const primitive::string_parser token_parser::single_quoted("'");
+const primitive::string_parser token_parser::double_quoted("\"");
+
+token_parser::token_parser() : token_parser(std::make_shared<symbols::symbol_table>()) {}
+
+token_parser::token_parser(std::shared_ptr<symbols::symbol_table> _table)
+    : table(std::move(_table)), keyword_true(table->intern("true")), keyword_false(table->intern("false")) {}
+
+void token_parser::skip(std::istream &is) {
+    for (int c = is.peek(); c != -1 && lexers[c] == lexer::space; c = is.peek()) {
+        is.ignore();
+    }
+}
+
+either<token, token_errors> token_parser::mark(std::istream &is) const {
+    auto e = marks(is);
+    if (e.is_left()) {
+        return left(token_errors::bad_mark);
+    }
+    const auto &[pos, id] = e.get_right();
+    return right(token(id, std::monostate(), pos));
+}
+
+either<token, token_errors> token_parser::sign(std::istream &is, bool operand) const {
+    if (operand) {
+        return mark(is);
+    }
+    is.ignore();
+    const int next = is.peek();
+    is.unget();
+
+    if ('0' <= next && next <= '9') {
+        return number(is);
+    }
+    return mark(is);
+}
+
+either<token, token_errors> token_parser::number(std::istream &is) const {
+    const std::streampos begin = is.tellg();
+
+    const auto integer = primitive::integer_parser<int>()(is);
+    if (integer.is_left()) {
+        return left(token_errors::bad_integer);
+    }
+    if (is.peek() != '.') {
+        return right(token(token_id::integer, integer.get_right(), position(begin, primitive::tell(is))));
+    }
+
+    // [0-9]+ was the integral part of a real
+    primitive::rewind(is, begin);
+    const auto real = primitive::real_parser<float>()(is);
+    if (real.is_left()) {
+        return left(token_errors::bad_real);
+    }
+    return right(token(token_id::real, real.get_right(), position(begin, primitive::tell(is))));
+}
+
+either<token, token_errors> token_parser::identifier(std::istream &is, std::string &scratch) const {
+    const std::streampos begin = is.tellg();
+
+    const auto name = symbols::identifier_parser(*table)(is, scratch);
+    if (name.is_left()) {
+        return left(token_errors::bad_identifier);
+    }
+    const position pos(begin, primitive::tell(is));
+
+    const symbol s = name.get_right();
+    if (s == keyword_true || s == keyword_false) {
+        return right(token(token_id::boolean, s == keyword_true, pos));
+    }
+    return right(token(token_id::variable, s, pos));
+}
+
+either<token, token_errors> token_parser::text(std::istream &is, std::string &scratch,
+                                               std::pmr::memory_resource *resource) const {
+    const std::streampos begin = is.tellg();
+
+    // decoded into scratch, so the value is allocated once at its final size
+    const auto e = is.peek() == '\'' ? single_quoted(is, scratch) : double_quoted(is, scratch);
+    if (e.is_left()) {
+        return left(token_errors::bad_text);
+    }
+    return right(token(token_id::text, text_t(e.get_right(), resource), position(begin, primitive::tell(is))));
+}
+
+either<token, token_errors> token_parser::lex(std::istream &is, bool operand) const {
+    std::string scratch;
+    return lex(is, scratch, operand);
+}
+
+either<token, token_errors> token_parser::lex(std::istream &is, std::string &scratch, bool operand,
+                                              std::pmr::memory_resource *resource) const {
+    skip(is);
+
+    const int c = is.peek();
+    if (c == -1) {
+        return left(token_errors::end_of_input);
+    }
+
+    switch (lexers[c]) {
+    case lexer::mark:
+        return mark(is);
+    case lexer::sign:
+        return sign(is, operand);
+    case lexer::number:
+        return number(is);
+    case lexer::identifier:
+        return identifier(is, scratch);
+    case lexer::text:
+        return text(is, scratch, resource);
+    case lexer::none:
+        return left(token_errors::unexpected_character);
+    default:
+        throw std::domain_error("lexer domain error");
+    }
+}
+
+template <class Sink>
+std::optional<token_errors> token_parser::lex_into(Sink &tokens, std::istream &is, std::string &scratch,
+                                                   std::pmr::memory_resource *resource) const {
+    bool operand = false;
+    for (skip(is); is.peek() != -1; skip(is)) {
+        std::streampos begin;
+        if constexpr (recovering_sink<Sink>) {
+            begin = primitive::tell(is);
+        }
+        auto e = lex(is, scratch, operand, resource);
+        if (e.is_left()) {
+            if constexpr (recovering_sink<Sink>) {
+                tokens.failed(begin, e.get_left());
+                resync(is, begin);
+                continue;
+            } else {
+                return e.get_left();
             }
-            return table;
-        }())
-            .positioned()
-            .map_right([](const std::tuple<position, token_id> &args) {
-                const auto &[pos, id] = args;
-                return token(id, std::monostate(), pos);
-            })
-            .const_left(std::string("failed to parse marks"));
-
-    const static auto integer = tokenizes::integer()
-                                    .positioned()
-                                    .map_right([](const std::tuple<position, int> &args) {
-                                        const auto &[pos, value] = args;
-                                        return token(token_id::integer, value, pos);
-                                    })
-                                    .const_left(std::string("failed to parse integer"));
-
-    const static auto parser = combinators::branch(marks, integer);
-
-    return parser(is);
+        }
+        operand = ends_operand(e.get_right().id);
+        tokens.push_back(std::move(e.get_right()));
+    }
+    return std::nullopt;
+}
+
+either<token, std::string> token_parser::operator()(std::istream &is) const {
+    auto e = lex(is, false);
+    if (e.is_left()) {
+        return left(std::string(message_of(e.get_left())));
+    }
+    return e.into_right();
+}
+
+either<std::vector<token>, std::string> token_parser::tokenize(std::istream &is) const {
+    std::vector<token> tokens;
+    std::string scratch;
+    if (const auto error = lex_into(tokens, is, scratch, std::pmr::get_default_resource())) {
+        return left(std::string(message_of(*error)));
+    }
+    return right(std::move(tokens));
+}
+
+either<std::vector<token>, std::string> token_parser::tokenize(std::string_view text) const {
+    auto e = structurals::structural_lexer(table).tokenize(text);
+    if (e.is_left()) {
+        return left(std::move(e.get_left()));
+    }
+    lazy_tokens &lazy = e.get_right();
+    lazy.set_caching(false);
+
+    std::vector<token> tokens;
+    tokens.reserve(lazy.size());
+    for (size_t i = 0; i < lazy.size(); i++) {
+        tokens.push_back(lazy.at(i));
+    }
+    return right(std::move(tokens));
+}
+
+either<std::pmr::vector<token>, std::string> token_parser::tokenize(std::istream &is,
+                                                                    std::pmr::memory_resource *resource) const {
+    std::pmr::vector<token> tokens(resource);
+    std::string scratch;
+    if (const auto error = lex_into(tokens, is, scratch, resource)) {
+        return left(std::string(message_of(*error)));
+    }
+    return right(std::move(tokens));
+}
+
+either<std::span<const token>, std::string> token_parser::tokenize(std::string_view text,
+                                                                   token_context &context) const {
+    context.buffer.reset(text);
+    context.stream.clear();
+    context.tokens.clear();
+    if (const auto error = lex_into(context.tokens, context.stream, context.scratch, std::pmr::get_default_resource())) {
+        return left(std::string(message_of(*error)));
+    }
+    return right(std::span<const token>(context.tokens));
+}
+
+either<std::pmr::vector<token>, std::string> token_parser::tokenize(std::string_view text, token_context &context,
+                                                                    std::pmr::memory_resource *resource) const {
+    context.buffer.reset(text);
+    context.stream.clear();
+    context.tokens.clear();
+
+    // values are lexed onto resource, and the tokens gathered in context before one exactly sized vector is taken
+    if (const auto error = lex_into(context.tokens, context.stream, context.scratch, resource)) {
+        return left(std::string(message_of(*error)));
+    }
+    std::pmr::vector<token> tokens(resource);
+    tokens.reserve(context.tokens.size());
+    std::move(context.tokens.begin(), context.tokens.end(), std::back_inserter(tokens));
+    return right(std::move(tokens));
+}
+
+either<token_buffer, std::string> token_parser::tokenize_buffer(std::istream &is) const {
+    token_buffer tokens;
+    std::string scratch;
+    if (const auto error = lex_into(tokens, is, scratch, std::pmr::get_default_resource())) {
+        return left(std::string(message_of(*error)));
+    }
+    return right(std::move(tokens));
+}
+
+void token_parser::resync(std::istream &is, std::streampos begin) {
+    // a failed sub-lexer may leave failbit without eofbit
+    is.clear();
+    primitive::rewind(is, begin);
+    const lexer failed = lexers[is.get()];
+    const auto boundary = [failed](int c) {
+        const lexer next = lexers[c];
+        switch (failed) {
+        case lexer::none:
+            return next != lexer::none;
+        case lexer::text:
+            return c == '\n';
+        default:
+            return next == lexer::space || next == lexer::mark || next == lexer::sign || next == lexer::text;
+        }
+    };
+    for (int c = is.peek(); c != -1 && !boundary(c); c = is.peek()) {
+        is.ignore();
+    }
+}
+
+namespace {
+
+// collects the tokens and a diagnostic per error of a recovering lex_into
+struct recovery_sink {
+    recovery &r;
+
+    void push_back(token &&t) { r.tokens.push_back(std::move(t)); }
+    void failed(std::streampos begin, token_errors error) {
+        r.diagnostics.push_back({static_cast<uint64_t>(std::streamoff(begin)), error});
+    }
+};
+
+} // namespace
+
+recovery token_parser::recover(std::istream &is) const {
+    recovery r;
+    recovery_sink sink{r};
+    std::string scratch;
+    lex_into(sink, is, scratch, std::pmr::get_default_resource());
+    return r;
 }
 
 } // namespace tokenizes::tokens
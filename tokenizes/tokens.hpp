@@ -1,15 +1,25 @@
 #pragma once
 #include "either.hpp"
+#include "inputs.hpp"
 #include "mappers.hpp"
 #include "primitive.hpp"
+#include "symbols.hpp"
+#include <array>
 #include <ios>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <variant>
+#include <vector>
 namespace tokenizes::tokens {
 
 using eithers::either;
 using mappers::position;
+using symbols::symbol;
 
 constexpr static inline uint32_t token_id_specials = 0 << 16;
 constexpr static inline uint32_t token_id_marks = 1 << 16;
@@ -28,40 +38,232 @@ enum class token_id : uint32_t {
     mul,
     div,
     mod,
+    lparen,
+    rparen,
 };
 
 std::ostream &operator<<(std::ostream &, token_id);
 
+// source text of a mark, empty for other ids
+std::string_view mark_of(token_id);
+
+// longest mark at the start of text, with its length
+std::optional<std::tuple<token_id, size_t>> match_mark(std::string_view text);
+
 constexpr static inline bool is_mark(token_id id) {
     const uint32_t value = static_cast<uint32_t>(id);
     return (value & token_id_marks) == token_id_marks;
 }
 
-using value_t = std::variant<std::monostate, bool, int, float, std::string>;
+/** whether a token of this id may end an operand
+ * a sign after such a token is a mark (x-1, 1-2, (a)-1), elsewhere it begins a number (-1, (-1), a*-1).
+ */
+constexpr static inline bool ends_operand(token_id id) {
+    return !is_mark(id) || id == token_id::rparen;
+}
+
+// decoded text of a text token, allocated from the resource its token was lexed with
+using text_t = std::pmr::string;
+
+using value_t = std::variant<std::monostate, bool, int, float, text_t, symbol>;
 
 std::ostream &operator<<(std::ostream &, const value_t &);
 
+// value moved or copied onto alloc (a text is reallocated unless alloc is its own)
+value_t value_with(value_t &&value, const std::pmr::polymorphic_allocator<> &alloc);
+
+/** lexed token
+ * allocator-aware: a std::pmr::vector<token> constructs its tokens with its own allocator,
+ * so text values live in the vector's arena as well.
+ */
 struct token {
-    const token_id id;
-    const value_t value;
-    const position pos;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    token_id id;
+    value_t value;
+    position pos;
 
     token(token_id _id, const value_t &_value, const position &_pos) : id(_id), value(_value), pos(_pos) {}
-    token(token_id _id, value_t &&_value, position &&_pos) : id(_id), value(_value), pos(_pos) {}
+    token(token_id _id, value_t &&_value, position &&_pos) : id(_id), value(std::move(_value)), pos(_pos) {}
+    token(const token &) = default;
+    token(token &&) = default;
+    token(const token &t, const allocator_type &alloc) : id(t.id), value(value_with(value_t(t.value), alloc)), pos(t.pos) {}
+    token(token &&t, const allocator_type &alloc) : id(t.id), value(value_with(std::move(t.value), alloc)), pos(t.pos) {}
+    token &operator=(const token &) = default;
+    token &operator=(token &&) = default;
 };
 
 std::ostream &operator<<(std::ostream &, const token &);
 
+/** 16-byte token
+ * payload holds the value itself when it fits 32 bits (bool, int, float bits, symbol id),
+ * or the index of a text in the owning buffer.
+ */
+struct compact_token {
+    token_id id;
+    uint32_t offset;
+    uint32_t length;
+    uint32_t payload;
+};
+
+static_assert(sizeof(compact_token) == 16);
+
+/** tokens as parallel columns (structure of arrays)
+ * ids, offsets, lengths and payloads are contiguous, so filters over one column stay in cache and vectorize;
+ * texts are pooled and referenced by payload.
+ */
+class token_buffer {
+    std::vector<token_id> ids;
+    std::vector<uint32_t> offsets, lengths, payloads;
+    std::vector<std::string> texts;
+
+public:
+    token_buffer() = default;
+
+    void reserve(size_t n);
+    // throws std::length_error when the position does not fit 32 bits
+    void push_back(const token &t);
+    void push_back(token &&t);
+    void clear();
+
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+    compact_token operator[](size_t i) const { return {ids[i], offsets[i], lengths[i], payloads[i]}; }
+    value_t value(size_t i) const;
+    token at(size_t i) const;
+
+    std::span<const token_id> get_ids() const { return ids; }
+    std::span<const uint32_t> get_offsets() const { return offsets; }
+    std::span<const uint32_t> get_lengths() const { return lengths; }
+    std::span<const uint32_t> get_payloads() const { return payloads; }
+    const std::vector<std::string> &get_texts() const { return texts; }
+};
+
+// second stage input: combinators run over lexed tokens and backtrack by index
+using token_input = inputs::span_input<token>;
+
+// a single token of the given kind
+class token_tag {
+    token_id id;
+
+public:
+    using input_t = token_input;
+
+    token_tag(token_id _id) : id(_id) {}
+    either<token, std::nullptr_t> operator()(token_input &in) const;
+    token_id get_id() const { return id; }
+};
+
+enum class token_errors : uint8_t {
+    end_of_input,
+    unexpected_character,
+    bad_mark,
+    bad_integer,
+    bad_real,
+    bad_identifier,
+    bad_text,
+};
+
+std::ostream &operator<<(std::ostream &, token_errors);
+
+// message reported by token_parser::operator()
+std::string_view message_of(token_errors);
+
+// recovered error: where the failed token began and why it failed
+struct diagnostic {
+    uint64_t offset; // streams may run past 4 GiB, unlike the 32 bit token buffers
+    token_errors kind;
+};
+
+std::ostream &operator<<(std::ostream &, const diagnostic &);
+
+// every token that could be read, plus the errors skipped on the way
+struct recovery {
+    std::vector<token> tokens;
+    std::vector<diagnostic> diagnostics;
+};
+
+/** per-thread state for a shared token_parser
+ * the stream, the token vector and identifier scratch are reused, so a warm context stops allocating for them.
+ */
+class token_context {
+    inputs::view_streambuf buffer;
+    std::istream stream{&buffer};
+    std::vector<token> tokens;
+    std::string scratch;
+
+    friend class token_parser;
+
+public:
+    token_context() = default;
+};
+
+template <class S>
+concept recovering_sink = requires(S &s, std::streampos begin, token_errors error) { s.failed(begin, error); };
+
+/** lexer for the token language
+ * immutable once constructed: one instance may be used from any number of threads at once.
+ * the grammar is static and read-only, and a call only writes to its stream (or token_context),
+ * except that names seen for the first time are interned into the shared symbol table under its lock.
+ */
 class token_parser {
 public:
     using mark_parser = mappers::positioned<mappers::tag_mapper<token_id>>;
 
+    // sub-lexer selected by the first byte of a token
+    enum class lexer : uint8_t { none, space, mark, sign, number, identifier, text };
+    using lexer_table = std::array<lexer, 256>;
+
 private:
     const static mark_parser marks;
+    const static lexer_table lexers;
+    const static primitive::string_parser single_quoted, double_quoted;
+    std::shared_ptr<symbols::symbol_table> table;
+    symbol keyword_true, keyword_false;
+
+    static void skip(std::istream &is);
+    // moves past a token that failed at begin, to the next byte that may start one
+    static void resync(std::istream &is, std::streampos begin);
+    either<token, token_errors> mark(std::istream &is) const;
+    // operand: the previous token ends an operand, so the sign is a mark
+    either<token, token_errors> sign(std::istream &is, bool operand) const;
+    either<token, token_errors> number(std::istream &is) const;
+    either<token, token_errors> identifier(std::istream &is, std::string &scratch) const;
+    // the text value is allocated from resource
+    either<token, token_errors> text(std::istream &is, std::string &scratch, std::pmr::memory_resource *resource) const;
+    either<token, token_errors> lex(std::istream &is, std::string &scratch, bool operand,
+                                    std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const;
+    either<token, token_errors> lex(std::istream &is, bool operand) const;
+    /** lexes is to its end into tokens.push_back, stopping at the first error
+     * a recovering_sink is told of each error through failed(begin, error) instead, and lexing resumes after it.
+     */
+    template <class Sink>
+    std::optional<token_errors> lex_into(Sink &tokens, std::istream &is, std::string &scratch,
+                                         std::pmr::memory_resource *resource) const;
 
 public:
     token_parser();
-    either<token, std::string> operator()(std::istream &is);
+    token_parser(std::shared_ptr<symbols::symbol_table> _table);
+    either<token, std::string> operator()(std::istream &is) const;
+    either<std::vector<token>, std::string> tokenize(std::istream &is) const;
+    // contiguous text through the structural (two-stage) lexer: same tokens, values decoded afterwards
+    either<std::vector<token>, std::string> tokenize(std::string_view text) const;
+    either<token_buffer, std::string> tokenize_buffer(std::istream &is) const;
+    // tokens of text, kept in context until its next use
+    either<std::span<const token>, std::string> tokenize(std::string_view text, token_context &context) const;
+    // tokens of text and their values allocated from resource, into an exactly sized vector
+    either<std::pmr::vector<token>, std::string> tokenize(std::string_view text, token_context &context,
+                                                          std::pmr::memory_resource *resource) const;
+    // tokens allocated from resource, e.g. a per-document arena
+    either<std::pmr::vector<token>, std::string> tokenize(std::istream &is, std::pmr::memory_resource *resource) const;
+    /** tokenizes to the end, recording each error instead of stopping
+     * after an error the input is resynchronized through the lexer table:
+     * a run of unexpected characters up to the next byte that starts a token,
+     * a broken text to the end of its line, anything else up to the next space, mark or quote.
+     */
+    recovery recover(std::istream &is) const;
+    symbols::symbol_table &get_symbols() const { return *table; }
+    static const lexer_table &get_lexers() { return lexers; }
 };
 
 } // namespace tokenizes::tokens
\ No newline at end of file
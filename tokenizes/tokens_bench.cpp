@@ -0,0 +1,226 @@
+#include "batches.hpp"
+#include "benches.hpp"
+#include "lazies.hpp"
+#include "perfs.hpp"
+#include "pipelines.hpp"
+#include "structurals.hpp"
+#include "tokens.hpp"
+#include <benchmark/benchmark.h>
+#include <iterator>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace tokenizes::tokens;
+using tokenizes::allocs::counting_scope;
+using tokenizes::benches::allocation_counters;
+using tokenizes::benches::hardware_counters;
+using tokenizes::perfs::perf_counters;
+using tokenizes::perfs::perf_sample;
+
+namespace tokens_bench {
+
+// statement-like corpus: names, marks, integers in every base, reals, booleans and texts
+static std::string corpus(size_t size) {
+    const static char *const marks[] = {"=", "+", "-", "*", "/", "%"};
+    const static char *const names[] = {"x", "y", "count", "total_size", "index", "value_1"};
+    const static char *const others[] = {"0x1f", "0b101", "-42", "3.25", "true", "false", "'text\\n'", "\"quoted\""};
+
+    std::mt19937 random(0);
+    std::string text;
+    text.reserve(size + 32);
+    while (text.size() < size) {
+        text += names[random() % std::size(names)];
+        text += ' ';
+        text += marks[random() % std::size(marks)];
+        text += ' ';
+        if (random() % 2) {
+            text += std::to_string(random() % 100000);
+        } else {
+            text += others[random() % std::size(others)];
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+static void token_parser_throughput(benchmark::State &state) {
+    const std::string text = corpus(state.range(0));
+    const token_parser parser;
+
+    size_t tokens = 0;
+    const counting_scope allocations;
+    const perf_counters counters;
+    const perf_sample start = counters.sample();
+    for (auto _ : state) {
+        std::stringstream ss(text);
+        auto e = parser.tokenize(ss);
+        if (!e.is_right()) {
+            state.SkipWithError("tokenize failed");
+            break;
+        }
+        tokens += e.get_right().size();
+        benchmark::DoNotOptimize(e);
+    }
+    const perf_sample used = counters.sample() - start;
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["tokens"] = benchmark::Counter(tokens, benchmark::Counter::kIsRate);
+    allocation_counters(state, allocations, tokens, "token");
+    hardware_counters(state, used, static_cast<double>(state.iterations()) * text.size(), tokens, "token");
+}
+BENCHMARK(token_parser_throughput)->Arg(4 << 10)->Arg(256 << 10);
+
+// std::regex over the same corpus: the baseline the hand-written lexers are measured against
+static void regex_baseline(benchmark::State &state) {
+    const std::string text = corpus(state.range(0));
+    const std::regex token(R"([A-Za-z_][A-Za-z0-9_]*|[+-]?(?:0[bqodx])?[0-9A-Fa-f]+(?:\.[0-9]+(?:[eE][+-]?[0-9]+)?)?)"
+                           R"(|'(?:[^'\\]|\\.)*'|"(?:[^"\\]|\\.)*"|[=+\-*/%()])");
+
+    size_t tokens = 0;
+    const perf_counters counters;
+    const perf_sample start = counters.sample();
+    for (auto _ : state) {
+        const std::sregex_iterator begin(text.begin(), text.end(), token), end;
+        tokens += std::distance(begin, end);
+    }
+    const perf_sample used = counters.sample() - start;
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["tokens"] = benchmark::Counter(tokens, benchmark::Counter::kIsRate);
+    hardware_counters(state, used, static_cast<double>(state.iterations()) * text.size(), tokens, "token");
+}
+BENCHMARK(regex_baseline)->Arg(4 << 10)->Arg(256 << 10);
+
+// one parser shared by every thread, each with its own context: throughput should grow with the thread count
+static void shared_parser_scaling(benchmark::State &state) {
+    static const token_parser parser;
+    const std::string text = corpus(state.range(0));
+    token_context context;
+
+    size_t tokens = 0;
+    const counting_scope allocations;
+    const perf_counters counters;
+    const perf_sample start = counters.sample();
+    for (auto _ : state) {
+        auto e = parser.tokenize(text, context);
+        if (!e.is_right()) {
+            state.SkipWithError("tokenize failed");
+            break;
+        }
+        tokens += e.get_right().size();
+        benchmark::DoNotOptimize(e);
+    }
+    const perf_sample used = counters.sample() - start;
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["tokens"] = benchmark::Counter(tokens, benchmark::Counter::kIsRate);
+    // the first iteration warms the context, the rest should not allocate
+    allocation_counters(state, allocations, tokens, "token");
+    hardware_counters(state, used, static_cast<double>(state.iterations()) * text.size(), tokens, "token");
+}
+BENCHMARK(shared_parser_scaling)->Arg(64 << 10)->ThreadRange(1, 32)->UseRealTime();
+
+// many documents of a few hundred bytes, as in message streams
+static std::vector<std::string> messages(size_t count) {
+    std::vector<std::string> texts;
+    for (size_t i = 0; i < count; i++) {
+        texts.push_back(corpus(256 + i % 256));
+    }
+    return texts;
+}
+
+static void small_documents_streams(benchmark::State &state) {
+    const std::vector<std::string> texts = messages(state.range(0));
+    size_t bytes = 0;
+    for (const auto &text : texts) {
+        bytes += text.size();
+    }
+
+    const token_parser parser;
+    for (auto _ : state) {
+        for (const auto &text : texts) {
+            std::stringstream ss(text);
+            auto e = parser.tokenize(ss);
+            benchmark::DoNotOptimize(e);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(small_documents_streams)->Arg(10000)->UseRealTime();
+
+static void small_documents_batch(benchmark::State &state) {
+    const std::vector<std::string> texts = messages(state.range(0));
+    const std::vector<std::string_view> documents(texts.begin(), texts.end());
+    size_t bytes = 0;
+    for (const auto &text : texts) {
+        bytes += text.size();
+    }
+
+    const token_parser parser;
+    for (auto _ : state) {
+        auto batch = tokenizes::batches::tokenize_batch(parser, documents);
+        benchmark::DoNotOptimize(batch);
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(small_documents_batch)->Arg(10000)->UseRealTime();
+
+// reader and tokenizer threads overlapping with the consumer; counters come from the last run
+static void pipeline_throughput(benchmark::State &state) {
+    const std::string text = corpus(state.range(0));
+    tokenizes::pipelines::pipeline_options options;
+    options.block_size = 16 << 10;
+    const tokenizes::pipelines::token_pipeline pipeline(options);
+
+    tokenizes::pipelines::pipeline_stats stats;
+    const perf_counters counters;
+    const perf_sample start = counters.sample();
+    for (auto _ : state) {
+        std::stringstream ss(text);
+        auto e = pipeline.run(ss, [](const tokenizes::pipelines::token_chunk &chunk) { benchmark::DoNotOptimize(chunk); });
+        if (!e.is_right()) {
+            state.SkipWithError("pipeline failed");
+            break;
+        }
+        stats = e.get_right();
+    }
+    const perf_sample used = counters.sample() - start;
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["tokens"] = benchmark::Counter(stats.consumer.tokens * state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["reader_full_waits"] = stats.reader.full_waits;
+    state.counters["tokenizer_empty_waits"] = stats.tokenizer.empty_waits;
+    state.counters["tokenizer_peak_depth"] = stats.tokenizer.peak_depth;
+    hardware_counters(state, used, static_cast<double>(state.iterations()) * text.size(), stats.consumer.tokens * state.iterations(), "token");
+}
+BENCHMARK(pipeline_throughput)->Arg(1 << 20)->UseRealTime();
+
+// contiguous engines: byte-at-a-time span_lexer against the two-stage structural lexer
+template <class Lexer>
+static void contiguous_throughput(benchmark::State &state) {
+    const std::string text = corpus(state.range(0));
+    const Lexer lexer;
+
+    size_t tokens = 0;
+    const counting_scope allocations;
+    const perf_counters counters;
+    const perf_sample start = counters.sample();
+    for (auto _ : state) {
+        auto e = lexer.tokenize(text);
+        if (!e.is_right()) {
+            state.SkipWithError("tokenize failed");
+            break;
+        }
+        tokens += e.get_right().size();
+        benchmark::DoNotOptimize(e);
+    }
+    const perf_sample used = counters.sample() - start;
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["tokens"] = benchmark::Counter(tokens, benchmark::Counter::kIsRate);
+    allocation_counters(state, allocations, tokens, "token");
+    hardware_counters(state, used, static_cast<double>(state.iterations()) * text.size(), tokens, "token");
+}
+BENCHMARK(contiguous_throughput<span_lexer>)->Arg(256 << 10);
+BENCHMARK(contiguous_throughput<tokenizes::structurals::structural_lexer>)->Arg(256 << 10);
+
+} // namespace tokens_bench
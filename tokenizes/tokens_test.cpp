@@ -1,7 +1,461 @@
+#include "combinators.hpp"
+#include "lazies.hpp"
+#include "mappers.hpp"
+#include "repeats.hpp"
 #include "tokens.hpp"
 
 #include "gtest/gtest.h"
+#include <sstream>
+#include <thread>
 
 using namespace tokenizes::tokens;
 
-namespace tokens_tests {}
\ No newline at end of file
+namespace tokens_tests {
+
+TEST(token_parser, mark) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "=";
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().id, token_id::assign);
+}
+
+TEST(token_parser, integer) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "42";
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().id, token_id::integer);
+    EXPECT_EQ(e.get_right().value, value_t(42));
+}
+
+TEST(token_parser, variable) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "hello_world";
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().id, token_id::variable);
+    const symbol s = std::get<symbol>(e.get_right().value);
+    EXPECT_EQ(parser.get_symbols().name(s), "hello_world");
+}
+
+TEST(token_parser, variable_interned) {
+    token_parser parser;
+    std::stringstream x, y;
+    x << "name";
+    y << "name";
+    const auto ex = parser(x);
+    const auto ey = parser(y);
+    ASSERT_TRUE(ex.is_right() && ey.is_right());
+    EXPECT_EQ(ex.get_right().value, ey.get_right().value);
+    EXPECT_EQ(parser.get_symbols().find("name"), std::get<symbol>(ex.get_right().value));
+}
+
+TEST(token_parser, boolean) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "true false trueish";
+    const auto e = parser.tokenize(ss);
+    ASSERT_TRUE(e.is_right());
+    const auto &tokens = e.get_right();
+    ASSERT_EQ(tokens.size(), 3);
+    EXPECT_EQ(tokens[0].id, token_id::boolean);
+    EXPECT_EQ(tokens[0].value, value_t(true));
+    EXPECT_EQ(tokens[1].value, value_t(false));
+    EXPECT_EQ(tokens[2].id, token_id::variable);
+}
+
+TEST(token_parser, real) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "1.5";
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().id, token_id::real);
+    EXPECT_EQ(e.get_right().value, value_t(1.5f));
+}
+
+TEST(token_parser, text) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "'a\\n' \"b\"";
+    const auto e = parser.tokenize(ss);
+    ASSERT_TRUE(e.is_right());
+    ASSERT_EQ(e.get_right().size(), 2);
+    EXPECT_EQ(e.get_right()[0].id, token_id::text);
+    EXPECT_EQ(e.get_right()[0].value, value_t(text_t("a\n")));
+    EXPECT_EQ(e.get_right()[1].value, value_t(text_t("b")));
+}
+
+TEST(token_parser, signed_integer) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "-5";
+    const auto e = parser(ss);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().id, token_id::integer);
+    EXPECT_EQ(e.get_right().value, value_t(-5));
+}
+
+TEST(token_parser, sign_mark) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "- 5";
+    const auto e = parser.tokenize(ss);
+    ASSERT_TRUE(e.is_right());
+    ASSERT_EQ(e.get_right().size(), 2);
+    EXPECT_EQ(e.get_right()[0].id, token_id::sub);
+    EXPECT_EQ(e.get_right()[1].value, value_t(5));
+}
+
+TEST(token_parser, sign_after_operand) {
+    const token_parser parser;
+    const span_lexer lexer;
+    const std::pair<std::string, std::vector<token_id>> cases[]{
+        {"x-1", {token_id::variable, token_id::sub, token_id::integer}},
+        {"1-2", {token_id::integer, token_id::sub, token_id::integer}},
+        {"1.5+2", {token_id::real, token_id::add, token_id::integer}},
+        {"(a)-1", {token_id::lparen, token_id::variable, token_id::rparen, token_id::sub, token_id::integer}},
+        {"a*-1", {token_id::variable, token_id::mul, token_id::integer}},
+        {"(-1)", {token_id::lparen, token_id::integer, token_id::rparen}},
+        {"-1-1", {token_id::integer, token_id::sub, token_id::integer}},
+    };
+    for (const auto &[source, ids] : cases) {
+        std::stringstream ss(source);
+        const auto streamed = parser.tokenize(ss);
+        const auto structural = parser.tokenize(std::string_view(source));
+        const auto lazy = lexer.tokenize(source);
+        ASSERT_TRUE(streamed.is_right()) << source;
+        ASSERT_TRUE(structural.is_right()) << source;
+        ASSERT_TRUE(lazy.is_right()) << source;
+        ASSERT_EQ(streamed.get_right().size(), ids.size()) << source;
+        ASSERT_EQ(structural.get_right().size(), ids.size()) << source;
+        ASSERT_EQ(lazy.get_right().size(), ids.size()) << source;
+        for (size_t i = 0; i < ids.size(); i++) {
+            EXPECT_EQ(streamed.get_right()[i].id, ids[i]) << source << ' ' << i;
+            EXPECT_EQ(structural.get_right()[i].id, ids[i]) << source << ' ' << i;
+            EXPECT_EQ(lazy.get_right()[i].id, ids[i]) << source << ' ' << i;
+        }
+    }
+}
+
+TEST(token_parser, marks) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "=+-*/%";
+    const auto e = parser.tokenize(ss);
+    ASSERT_TRUE(e.is_right());
+    const std::vector<token_id> ids = {token_id::assign, token_id::add, token_id::sub,
+                                       token_id::mul,    token_id::div, token_id::mod};
+    ASSERT_EQ(e.get_right().size(), ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        EXPECT_EQ(e.get_right()[i].id, ids[i]);
+        EXPECT_EQ(e.get_right()[i].pos.begin, i);
+        EXPECT_EQ(e.get_right()[i].pos.end, i + 1);
+    }
+}
+
+TEST(token_parser, statement) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "x = 0x10 * y";
+    const auto e = parser.tokenize(ss);
+    ASSERT_TRUE(e.is_right());
+    const std::vector<token_id> ids = {token_id::variable, token_id::assign, token_id::integer, token_id::mul,
+                                       token_id::variable};
+    ASSERT_EQ(e.get_right().size(), ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        EXPECT_EQ(e.get_right()[i].id, ids[i]);
+    }
+    EXPECT_EQ(e.get_right()[2].value, value_t(16));
+}
+
+TEST(token_parser, unexpected) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "x $";
+    EXPECT_TRUE(parser.tokenize(ss).is_left());
+}
+
+TEST(token_parser, end_of_input) {
+    token_parser parser;
+    std::stringstream ss;
+    ss << "  ";
+    EXPECT_TRUE(parser(ss).is_left());
+}
+
+} // namespace tokens_tests
+
+namespace token_input_tests {
+
+using namespace tokenizes;
+using combinators::operator*;
+
+static std::vector<token> lex(std::string_view text) {
+    const static token_parser parser;
+    std::stringstream ss;
+    ss << text;
+    return parser.tokenize(ss).get_right();
+}
+
+const static auto value = combinators::branch(token_tag(token_id::integer), token_tag(token_id::variable));
+const static auto statement = token_tag(token_id::variable) * token_tag(token_id::assign) * value;
+
+TEST(token_input, sequencer) {
+    const auto tokens = lex("x = 1");
+    token_input in(tokens);
+    const auto e = statement(in);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().size(), 3);
+    EXPECT_TRUE(in.eof());
+}
+
+TEST(token_input, branch) {
+    const auto tokens = lex("x = y");
+    token_input in(tokens);
+    ASSERT_TRUE(statement(in).is_right());
+    EXPECT_EQ(in.tellg(), 3);
+}
+
+TEST(token_input, failed) {
+    const auto tokens = lex("x = =");
+    token_input in(tokens);
+    EXPECT_TRUE(statement(in).is_left());
+}
+
+TEST(token_input, repeat) {
+    const auto tokens = lex("x = 1 y = z =");
+    token_input in(tokens);
+    const auto e = repeats::many0(statement)(in);
+    ASSERT_TRUE(e.is_right());
+    EXPECT_EQ(e.get_right().size(), 2);
+    EXPECT_EQ(in.tellg(), 6);
+}
+
+TEST(token_input, mappers) {
+    const auto tokens = lex("42");
+    token_input in(tokens);
+    const auto parser = mappers::positioned(
+        mappers::mapper_right(token_tag(token_id::integer), [](const token &t) { return std::get<int>(t.value); }));
+    const auto e = parser(in);
+    ASSERT_TRUE(e.is_right());
+    const auto &[pos, v] = e.get_right();
+    EXPECT_EQ(v, 42);
+    EXPECT_EQ(pos.begin, 0);
+    EXPECT_EQ(pos.end, 1);
+}
+
+} // namespace token_input_tests
+
+namespace recover_tests {
+
+using namespace tokenizes::tokens;
+
+static recovery recover(std::string_view text) {
+    const static token_parser parser;
+    std::stringstream ss;
+    ss << text;
+    return parser.recover(ss);
+}
+
+TEST(recover, clean) {
+    const auto r = recover("x = 1 + 2");
+    EXPECT_EQ(r.tokens.size(), 5);
+    EXPECT_TRUE(r.diagnostics.empty());
+}
+
+TEST(recover, unexpected) {
+    const auto r = recover("x = 1 @@@ y = 2 $ z");
+    ASSERT_EQ(r.diagnostics.size(), 2);
+    EXPECT_EQ(r.diagnostics[0].offset, 6);
+    EXPECT_EQ(r.diagnostics[0].kind, token_errors::unexpected_character);
+    EXPECT_EQ(r.diagnostics[1].offset, 16);
+    EXPECT_EQ(r.tokens.size(), 7);
+}
+
+TEST(recover, real) {
+    const auto r = recover("a = 1.x + 1");
+    ASSERT_EQ(r.diagnostics.size(), 1);
+    EXPECT_EQ(r.diagnostics[0].offset, 4);
+    EXPECT_EQ(r.diagnostics[0].kind, token_errors::bad_real);
+    ASSERT_EQ(r.tokens.size(), 4);
+    EXPECT_EQ(r.tokens[2].id, token_id::add);
+    EXPECT_EQ(r.tokens[3].value, value_t(1));
+}
+
+TEST(recover, text) {
+    const auto r = recover("'abc = 1\nx");
+    ASSERT_EQ(r.diagnostics.size(), 1);
+    EXPECT_EQ(r.diagnostics[0].kind, token_errors::bad_text);
+    ASSERT_EQ(r.tokens.size(), 1);
+    EXPECT_EQ(r.tokens[0].id, token_id::variable);
+}
+
+// a text that reports positions from base onwards, as if it came after base bytes of a longer stream
+class shifted_buffer : public std::stringbuf {
+    std::streamoff base;
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        const pos_type pos = std::stringbuf::seekoff(dir == std::ios_base::beg ? off - base : off, dir, which);
+        return pos == pos_type(off_type(-1)) ? pos : pos_type(std::streamoff(pos) + base);
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        const pos_type p = std::stringbuf::seekpos(std::streamoff(pos) - base, which);
+        return p == pos_type(off_type(-1)) ? p : pos_type(std::streamoff(p) + base);
+    }
+
+public:
+    shifted_buffer(const std::string &text, std::streamoff _base) : std::stringbuf(text), base(_base) {}
+};
+
+TEST(recover, past_4_gib) {
+    const std::streamoff base = std::streamoff(5) << 30;
+    shifted_buffer buffer("x = 1 @ y", base);
+    std::istream is(&buffer);
+    const auto r = token_parser().recover(is);
+    ASSERT_EQ(r.diagnostics.size(), 1);
+    EXPECT_EQ(r.diagnostics[0].offset, static_cast<uint64_t>(base) + 6);
+    EXPECT_EQ(r.tokens.size(), 4);
+}
+
+} // namespace recover_tests
+
+namespace token_buffer_tests {
+
+using namespace tokenizes::tokens;
+
+static_assert(std::is_move_assignable_v<token> && std::is_copy_assignable_v<token>);
+
+TEST(token_buffer, round_trip) {
+    const token_parser parser;
+    std::stringstream ss;
+    ss << "x = 'a' + 1.5 * true - 42";
+    const auto tokens = parser.tokenize(ss).get_right();
+
+    ss.clear(), ss.seekg(0);
+    const auto e = parser.tokenize_buffer(ss);
+    ASSERT_TRUE(e.is_right());
+    const token_buffer &buffer = e.get_right();
+    ASSERT_EQ(buffer.size(), tokens.size());
+    for (size_t i = 0; i < tokens.size(); i++) {
+        const token t = buffer.at(i);
+        EXPECT_EQ(t.id, tokens[i].id);
+        EXPECT_EQ(t.value, tokens[i].value);
+        EXPECT_EQ(t.pos.begin, tokens[i].pos.begin);
+        EXPECT_EQ(t.pos.end, tokens[i].pos.end);
+    }
+    EXPECT_EQ(buffer.get_texts().size(), 1);
+}
+
+TEST(token_buffer, columns) {
+    token_buffer buffer;
+    buffer.push_back(token(token_id::integer, -7, position(3, 5)));
+    buffer.push_back(token(token_id::add, std::monostate(), position(6, 7)));
+
+    const compact_token c = buffer[0];
+    EXPECT_EQ(c.id, token_id::integer);
+    EXPECT_EQ(c.offset, 3);
+    EXPECT_EQ(c.length, 2);
+    EXPECT_EQ(buffer.value(0), value_t(-7));
+    EXPECT_EQ(buffer.get_ids()[1], token_id::add);
+    EXPECT_EQ(buffer.get_offsets()[1], 6);
+}
+
+TEST(token_buffer, too_far) {
+    token_buffer buffer;
+    EXPECT_THROW(buffer.push_back(token(token_id::add, std::monostate(), position(0, size_t(1) << 32))),
+                 std::length_error);
+}
+
+} // namespace token_buffer_tests
+
+namespace token_context_tests {
+
+TEST(token_context, same_as_stream) {
+    const token_parser parser;
+    const std::string text = "x = 0x1f + 'a\\n' * -2.5 % y";
+    std::stringstream ss(text);
+    const auto expected = parser.tokenize(ss);
+    ASSERT_TRUE(expected.is_right());
+
+    token_context context;
+    const auto e = parser.tokenize(text, context);
+    ASSERT_TRUE(e.is_right());
+    const auto tokens = e.get_right();
+    ASSERT_EQ(tokens.size(), expected.get_right().size());
+    for (size_t i = 0; i < tokens.size(); i++) {
+        EXPECT_EQ(tokens[i].id, expected.get_right()[i].id);
+        EXPECT_EQ(tokens[i].value, expected.get_right()[i].value);
+        EXPECT_EQ(tokens[i].pos.begin, expected.get_right()[i].pos.begin);
+        EXPECT_EQ(tokens[i].pos.end, expected.get_right()[i].pos.end);
+    }
+}
+
+TEST(token_context, reused) {
+    const token_parser parser;
+    token_context context;
+
+    const auto failed = parser.tokenize("1 $", context);
+    ASSERT_TRUE(failed.is_left());
+    EXPECT_EQ(failed.get_left(), message_of(token_errors::unexpected_character));
+
+    const auto e = parser.tokenize("a + 1", context);
+    ASSERT_TRUE(e.is_right());
+    ASSERT_EQ(e.get_right().size(), 3);
+    EXPECT_EQ(e.get_right()[2].value, value_t(1));
+    EXPECT_EQ(e.get_right()[2].pos.begin, 4);
+}
+
+TEST(token_context, shared_parser) {
+    const token_parser parser;
+    const std::string text = "total = count * 3 + 'x' - offset_2 / 4.5";
+    std::stringstream ss(text);
+    const auto expected = parser.tokenize(ss);
+    ASSERT_TRUE(expected.is_right());
+
+    std::vector<size_t> mismatches(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < mismatches.size(); t++) {
+        threads.emplace_back([&, t]() {
+            token_context context;
+            for (int round = 0; round < 200; round++) {
+                const auto e = parser.tokenize(text, context);
+                if (!e.is_right() || e.get_right().size() != expected.get_right().size()) {
+                    mismatches[t]++;
+                    continue;
+                }
+                for (size_t i = 0; i < e.get_right().size(); i++) {
+                    mismatches[t] += e.get_right()[i].value != expected.get_right()[i].value;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (const size_t n : mismatches) {
+        EXPECT_EQ(n, 0);
+    }
+}
+
+TEST(view_streambuf, seek) {
+    tokenizes::inputs::view_streambuf buffer("abc");
+    std::istream is(&buffer);
+    EXPECT_EQ(is.get(), 'a');
+    EXPECT_EQ(is.tellg(), 1);
+    is.seekg(0, std::ios_base::end);
+    EXPECT_EQ(is.peek(), -1);
+    is.clear();
+    is.seekg(1);
+    EXPECT_EQ(is.get(), 'b');
+
+    buffer.reset("z");
+    is.seekg(0);
+    EXPECT_EQ(is.get(), 'z');
+}
+
+} // namespace token_context_tests
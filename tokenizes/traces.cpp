@@ -0,0 +1,125 @@
+#include "traces.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+namespace tokenizes::traces {
+
+using tokenizes::eithers::left;
+using tokenizes::eithers::right;
+using tokenizes::probes::trace_kind;
+
+namespace {
+
+constexpr char magic[4] = {'W', 'T', 'R', 'C'};
+constexpr uint32_t version = 1;
+
+template <class T>
+void put(std::ostream &os, const T &value) {
+    os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T>
+bool get(std::istream &is, T &value) {
+    return static_cast<bool>(is.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+// size bytes into s, grown as they arrive, so that a corrupt size fails on the stream rather than allocating
+bool get_string(std::istream &is, uint32_t size, std::string &s) {
+    char block[4096];
+    while (size > 0) {
+        const uint32_t n = std::min<uint32_t>(size, sizeof(block));
+        if (!is.read(block, n)) return false;
+        s.append(block, n);
+        size -= n;
+    }
+    return true;
+}
+
+} // namespace
+
+trace capture() { return {probes::node_names(), probes::recorded()}; }
+
+void write(std::ostream &os, const trace &t) {
+    os.write(magic, sizeof(magic));
+    put(os, version);
+    put(os, static_cast<uint32_t>(t.names.size()));
+    for (const std::string &name : t.names) {
+        put(os, static_cast<uint32_t>(name.size()));
+        os.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+    put(os, static_cast<uint64_t>(t.events.size()));
+    os.write(reinterpret_cast<const char *>(t.events.data()),
+             static_cast<std::streamsize>(t.events.size() * sizeof(trace_event)));
+}
+
+either<trace, std::string> read(std::istream &is) {
+    char head[sizeof(magic)];
+    uint32_t v = 0;
+    if (!is.read(head, sizeof(head)) || std::memcmp(head, magic, sizeof(magic)) != 0) {
+        return left<std::string>("not a trace file");
+    }
+    if (!get(is, v) || v != version) {
+        return left("unsupported trace version " + std::to_string(v));
+    }
+
+    trace t;
+    uint32_t count = 0;
+    if (!get(is, count)) {
+        return left<std::string>("truncated trace");
+    }
+    // count is not trusted for an allocation: names are added as they are read
+    for (; count > 0; count--) {
+        uint32_t size = 0;
+        if (!get(is, size) || !get_string(is, size, t.names.emplace_back())) {
+            return left<std::string>("truncated trace");
+        }
+    }
+
+    uint64_t events = 0;
+    if (!get(is, events)) {
+        return left<std::string>("truncated trace");
+    }
+    for (trace_event e; events > 0 && get(is, e); events--) {
+        if (e.node >= t.names.size() || e.kind > static_cast<uint32_t>(trace_kind::rewind)) {
+            return left("bad event at " + std::to_string(t.events.size()));
+        }
+        t.events.push_back(e);
+    }
+    if (events > 0) {
+        return left<std::string>("truncated trace");
+    }
+    return right(std::move(t));
+}
+
+void fold(const trace &t, std::ostream &os) {
+    std::vector<uint32_t> stack;
+    std::map<std::string, uint64_t> folded;
+    for (const trace_event &e : t.events) {
+        switch (static_cast<trace_kind>(e.kind)) {
+        case trace_kind::enter:
+            stack.push_back(e.node);
+            break;
+        case trace_kind::success:
+        case trace_kind::failure:
+            if (!stack.empty() && stack.back() == e.node) {
+                stack.pop_back();
+            }
+            break;
+        case trace_kind::rewind: {
+            if (e.rewound == 0) break;
+            std::string path;
+            for (const uint32_t node : stack) {
+                if (!path.empty()) path += ';';
+                path += t.names[node];
+            }
+            folded[path.empty() ? t.names[e.node] : path] += e.rewound;
+            break;
+        }
+        }
+    }
+    for (const auto &[path, bytes] : folded) {
+        os << path << ' ' << bytes << '\n';
+    }
+}
+
+} // namespace tokenizes::traces
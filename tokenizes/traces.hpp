@@ -0,0 +1,37 @@
+#pragma once
+#include "either.hpp"
+#include "probes.hpp"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+namespace tokenizes::traces {
+
+using tokenizes::eithers::either;
+using tokenizes::probes::trace_event;
+
+/** events of a trace ring with the names of the nodes they refer to
+ * built with TOKENIZE_TRACE, every probed node records into the ring of the calling thread.
+ */
+struct trace {
+    std::vector<std::string> names;
+    std::vector<trace_event> events;
+};
+
+// the calling thread's ring, oldest event first
+trace capture();
+
+/** binary trace file
+ * "WTRC", version, node names (length prefixed), then the events as laid out in memory (host byte order).
+ */
+void write(std::ostream &os, const trace &t);
+either<trace, std::string> read(std::istream &is);
+
+/** bytes rewound per grammar path, in folded-stack format ("a;b;c bytes" per line) for flamegraph.pl
+ * a path is the chain of nodes entered when the rewind happened, outermost first.
+ * events from before the start of the ring (exits without their entry) are skipped.
+ */
+void fold(const trace &t, std::ostream &os);
+
+} // namespace tokenizes::traces
@@ -0,0 +1,25 @@
+// converts a trace file (see traces.hpp) into folded stacks of rewound bytes:
+//   tokenize_fold trace.bin | flamegraph.pl --countname bytes > rewinds.svg
+#include "traces.hpp"
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <trace file>\n";
+        return 2;
+    }
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+        std::cerr << "cannot open " << argv[1] << '\n';
+        return 1;
+    }
+
+    auto t = tokenizes::traces::read(file);
+    if (!t.is_right()) {
+        std::cerr << argv[1] << ": " << t.get_left() << '\n';
+        return 1;
+    }
+    tokenizes::traces::fold(t.get_right(), std::cout);
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "combinators.hpp"
+#include "primitive.hpp"
+#include "probes.hpp"
+#include "traces.hpp"
+
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+using namespace tokenizes::traces;
+using tokenizes::primitive::tag;
+using tokenizes::probes::trace_kind;
+
+namespace traces_tests {
+
+trace_event event(trace_kind kind, uint32_t node, int64_t offset, uint32_t rewound = 0) {
+    trace_event e{};
+    e.offset = offset, e.node = node, e.kind = static_cast<uint32_t>(kind), e.rewound = rewound;
+    return e;
+}
+
+// branch#0 tries tag#1, which reads 3 bytes before failing, then tag#2
+const trace sample{
+    {"branch#0", "tag(abc)#1", "tag(abd)#2"},
+    {
+        event(trace_kind::enter, 0, 0),
+        event(trace_kind::enter, 1, 0),
+        event(trace_kind::rewind, 1, 0, 3),
+        event(trace_kind::failure, 1, 0),
+        event(trace_kind::enter, 2, 0),
+        event(trace_kind::success, 2, 3),
+        event(trace_kind::success, 0, 3),
+    },
+};
+
+TEST(fold, attributes_rewinds_to_paths) {
+    std::ostringstream os;
+    fold(sample, os);
+    EXPECT_EQ(os.str(), "branch#0;tag(abc)#1 3\n");
+}
+
+TEST(fold, skips_events_before_the_ring) {
+    trace t = sample;
+    t.events.erase(t.events.begin(), t.events.begin() + 2);
+    t.events.push_back(event(trace_kind::enter, 1, 3));
+    t.events.push_back(event(trace_kind::rewind, 1, 3, 1));
+
+    std::ostringstream os;
+    fold(t, os);
+    // without their entry, rewinds are charged to the rewinding node alone
+    EXPECT_EQ(os.str(), "tag(abc)#1 4\n");
+}
+
+TEST(trace_file, round_trip) {
+    std::stringstream ss;
+    write(ss, sample);
+    auto t = read(ss);
+    ASSERT_TRUE(t.is_right());
+    EXPECT_EQ(t.get_right().names, sample.names);
+    ASSERT_EQ(t.get_right().events.size(), sample.events.size());
+    EXPECT_EQ(t.get_right().events[2].rewound, 3);
+    EXPECT_EQ(t.get_right().events[5].offset, 3);
+}
+
+TEST(trace_file, rejects_bad_input) {
+    std::istringstream garbage("nope");
+    EXPECT_EQ(read(garbage).get_left(), "not a trace file");
+
+    std::stringstream ss;
+    write(ss, sample);
+    std::string bytes = ss.str();
+    bytes.resize(bytes.size() - 4);
+    std::istringstream truncated(bytes);
+    EXPECT_EQ(read(truncated).get_left(), "truncated trace");
+}
+
+TEST(trace_file, rejects_corrupt_counts) {
+    const auto header = [](uint32_t count, uint32_t size) {
+        std::string bytes("WTRC");
+        for (const uint32_t v : {1u, count, size}) {
+            bytes.append(reinterpret_cast<const char *>(&v), sizeof(v));
+        }
+        return bytes + "ab";
+    };
+    std::istringstream names(header(UINT32_MAX, 2));
+    EXPECT_EQ(read(names).get_left(), "truncated trace");
+    std::istringstream name(header(1, UINT32_MAX));
+    EXPECT_EQ(read(name).get_left(), "truncated trace");
+}
+
+TEST(trace_ring, keeps_the_last_events) {
+    using namespace tokenizes::probes;
+    set_trace_capacity(4);
+    for (int i = 0; i < 6; i++) {
+        record(trace_kind::enter, 0, i);
+    }
+    const auto events = recorded();
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(events.front().offset, 2);
+    EXPECT_EQ(events.back().offset, 5);
+
+    clear_trace();
+    EXPECT_TRUE(recorded().empty());
+    set_trace_capacity(1 << 16);
+}
+
+TEST(trace_ring, records_parsers) {
+    if constexpr (std::is_same_v<tokenizes::probes::probe, tokenizes::probes::tracing_probe>) {
+        using tokenizes::combinators::operator+;
+        const auto parser = tag("abc") + tag("abd");
+        std::istringstream ss("abd");
+        tokenizes::probes::clear_trace();
+        EXPECT_TRUE(parser(ss).is_right());
+
+        std::ostringstream os;
+        fold(capture(), os);
+        EXPECT_NE(os.str().find(";tag(abc)#"), std::string::npos);
+        EXPECT_EQ(os.str().back(), '\n');
+    } else {
+        GTEST_SKIP() << "built without TOKENIZE_TRACE";
+    }
+}
+
+} // namespace traces_tests
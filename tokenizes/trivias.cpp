@@ -0,0 +1,192 @@
+#include "trivias.hpp"
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+namespace tokenizes::trivias {
+
+using eithers::left;
+using eithers::right;
+
+std::ostream &operator<<(std::ostream &os, trivia_errors e) {
+    switch (e) {
+    case trivia_errors::unterminated_comment:
+        return os << "unterminated_comment";
+    default:
+        return os << "unknown";
+    }
+}
+
+trivia::trivia(const primitive::atom &_spaces, std::string_view _line, std::string_view _open,
+               std::string_view _close)
+    : spaces(_spaces), line(_line), open(_open), close(_close) {
+    if (line.size() > max_delimiter || open.size() > max_delimiter || close.size() > max_delimiter) {
+        throw std::invalid_argument("comment delimiter is too long");
+    }
+    if (open.empty() != close.empty()) {
+        throw std::invalid_argument("block comment needs both delimiters");
+    }
+
+    for (unsigned c = 0; c < 256; c++) {
+        if (!spaces.get_chars().test(c)) continue;
+        if (c >= 0x80) {
+            ascii = false;
+            continue;
+        }
+        low_table[c & 0xf] |= 1 << (c >> 4);
+        if (space_count < space_list.size()) {
+            space_list[space_count] = static_cast<char>(c);
+        }
+        space_count++;
+    }
+    for (unsigned h = 0; h < 8; h++) {
+        high_table[h] = 1 << h;
+    }
+}
+
+size_t trivia::skip_spaces(const char *p, size_t n) const {
+    size_t i = 0;
+#if defined(__SSSE3__)
+    if (ascii) {
+        const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i *>(low_table.data()));
+        const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i *>(high_table.data()));
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+            const __m128i l = _mm_shuffle_epi8(low, _mm_and_si128(v, nibble));
+            const __m128i h = _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+            const __m128i other = _mm_cmpeq_epi8(_mm_and_si128(l, h), _mm_setzero_si128());
+            if (const unsigned mask = _mm_movemask_epi8(other); mask) {
+                return i + std::countr_zero(mask);
+            }
+        }
+    }
+#elif defined(__SSE2__)
+    if (ascii && space_count <= space_list.size()) {
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+            __m128i member = _mm_setzero_si128();
+            for (size_t k = 0; k < space_count; k++) {
+                member = _mm_or_si128(member, _mm_cmpeq_epi8(v, _mm_set1_epi8(space_list[k])));
+            }
+            if (const unsigned mask = ~_mm_movemask_epi8(member) & 0xffff; mask) {
+                return i + std::countr_zero(mask);
+            }
+        }
+    }
+#endif
+    for (; i < n && spaces.get_chars().test(static_cast<unsigned char>(p[i])); i++) {
+    }
+    return i;
+}
+
+int trivia::starts_with(const char *p, size_t n, std::string_view delimiter, bool more) {
+    if (n >= delimiter.size()) {
+        return std::memcmp(p, delimiter.data(), delimiter.size()) == 0;
+    }
+    return more && std::memcmp(p, delimiter.data(), n) == 0 ? -1 : 0;
+}
+
+trivia::scan_result trivia::scan(std::string_view text, trivia_state &state, bool more) const {
+    const char *p = text.data();
+    const size_t n = text.size();
+    size_t i = 0, opened = SIZE_MAX;
+    while (i < n) {
+        switch (state) {
+        case trivia_state::space: {
+            i += skip_spaces(p + i, n - i);
+            if (i == n) {
+                return {n, opened, false};
+            }
+            if (!line.empty()) {
+                const int m = starts_with(p + i, n - i, line, more);
+                if (m < 0) return {i, opened, false};
+                if (m > 0) {
+                    i += line.size(), state = trivia_state::line;
+                    continue;
+                }
+            }
+            if (!open.empty()) {
+                const int m = starts_with(p + i, n - i, open, more);
+                if (m < 0) return {i, opened, false};
+                if (m > 0) {
+                    opened = i, i += open.size(), state = trivia_state::block;
+                    continue;
+                }
+            }
+            return {i, opened, true};
+        }
+        case trivia_state::line: {
+            const char *end = static_cast<const char *>(std::memchr(p + i, '\n', n - i));
+            if (!end) {
+                return {n, opened, false};
+            }
+            i = end - p + 1, state = trivia_state::space;
+            break;
+        }
+        case trivia_state::block: {
+            const char *end = static_cast<const char *>(std::memchr(p + i, close[0], n - i));
+            if (!end) {
+                return {n, opened, false};
+            }
+            const size_t j = end - p;
+            const int m = starts_with(end, n - j, close, more);
+            if (m < 0) return {j, opened, false};
+            i = m > 0 ? (state = trivia_state::space, j + close.size()) : j + 1;
+            break;
+        }
+        }
+    }
+    return {n, opened, false};
+}
+
+size_t trivia::skip(std::string_view text) const {
+    trivia_state state = trivia_state::space;
+    return scan(text, state, false).used;
+}
+
+either<std::nullptr_t, trivia_errors> trivia::operator()(std::istream &is) const {
+    // most calls are between tokens with nothing to skip: decided on one byte, without a seek or a chunk copy
+    if (const int c = is.peek(); c != -1 && !spaces.get_chars().test(c) &&
+                                 (line.empty() || c != static_cast<unsigned char>(line[0])) &&
+                                 (open.empty() || c != static_cast<unsigned char>(open[0]))) {
+        return right(nullptr);
+    }
+
+    const std::streampos start = primitive::tell(is);
+    if (start == std::streampos(-1)) {
+        for (int c = is.peek(); c != -1 && spaces.get_chars().test(c); c = is.peek()) {
+            is.ignore();
+        }
+        return right(nullptr);
+    }
+
+    std::streambuf *buf = is.rdbuf();
+    char chunk[chunk_size];
+    trivia_state state = trivia_state::space;
+    std::streamoff pos = start, opened = start;
+    for (;;) {
+        buf->pubseekpos(pos, std::ios_base::in);
+        const size_t n = static_cast<size_t>(buf->sgetn(chunk, chunk_size));
+        const bool more = n == chunk_size;
+        const scan_result r = scan({chunk, n}, state, more);
+        if (r.opened != SIZE_MAX) {
+            opened = pos + static_cast<std::streamoff>(r.opened);
+        }
+        pos += static_cast<std::streamoff>(r.used);
+        if (r.done || !more) break;
+    }
+
+    if (state == trivia_state::block) {
+        primitive::rewind(is, opened);
+        return left(trivia_errors::unterminated_comment);
+    }
+    primitive::rewind(is, pos);
+    return right(nullptr);
+}
+
+} // namespace tokenizes::trivias
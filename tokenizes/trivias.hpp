@@ -0,0 +1,98 @@
+#pragma once
+#include "concepts.hpp"
+#include "either.hpp"
+#include "firsts.hpp"
+#include "primitive.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+namespace tokenizes::trivias {
+
+using tokenizes::concepts::either_of;
+using tokenizes::concepts::parsable;
+using tokenizes::eithers::either;
+using tokenizes::eithers::either_mode;
+
+enum class trivia_errors { unterminated_comment };
+
+std::ostream &operator<<(std::ostream &, trivia_errors);
+
+// where a scan stopped: inside spaces, a line comment or a block comment
+enum class trivia_state : uint8_t { space, line, block };
+
+/** whitespace, line comments and block comments
+ * an empty delimiter disables that kind of comment; block comments do not nest.
+ * whitespace runs are matched 16 bytes at a time (pshufb nibble lookup under SSSE3, compares under SSE2),
+ * comment terminators are searched with memchr.
+ * istreams are read through rdbuf in chunks and sought back to the first byte that is not trivia,
+ * which needs a seekable stream; otherwise only whitespace is skipped, one byte at a time.
+ * when the next byte is neither a space nor the first byte of a comment delimiter, nothing is read past it.
+ */
+class trivia {
+public:
+    constexpr static size_t chunk_size = 256;
+    constexpr static size_t max_delimiter = 16;
+
+    struct scan_result {
+        size_t used;   // bytes known to be trivia
+        size_t opened; // offset of the block comment entered last, if any
+        bool done;     // used is the first byte that is not trivia
+    };
+
+private:
+    primitive::atom spaces;
+    std::string line, open, close;
+    // spaces as (low nibble -> high nibble bits, high nibble -> bit) for pshufb; unset if not ascii
+    alignas(16) std::array<uint8_t, 16> low_table{}, high_table{};
+    // spaces listed for plain SSE2 compares, when there are at most 8 of them
+    std::array<char, 8> space_list{};
+    size_t space_count{0};
+    bool ascii{true};
+
+    size_t skip_spaces(const char *p, size_t n) const;
+    // delimiter at p: 1 if matched, 0 if not, -1 if it may continue past n
+    static int starts_with(const char *p, size_t n, std::string_view delimiter, bool more);
+
+public:
+    trivia(const primitive::atom &_spaces = primitive::space, std::string_view _line = "//",
+           std::string_view _open = "/*", std::string_view _close = "*/");
+
+    /** scans text from state
+     * with more set, delimiters cut by the end of text are left unconsumed for the next call.
+     */
+    scan_result scan(std::string_view text, trivia_state &state, bool more) const;
+    // offset of the first byte that is not trivia; unterminated block comments run to the end
+    size_t skip(std::string_view text) const;
+
+    either<std::nullptr_t, trivia_errors> operator()(std::istream &is) const;
+
+    // matches the empty string
+    firsts::first_set first() const { return firsts::any(); }
+    const primitive::atom &get_spaces() const { return spaces; }
+};
+
+/** parser followed by trivia
+ * an unterminated comment is left in place for the next parser to fail on.
+ */
+template <parsable P>
+class lexeme {
+    P parser;
+    trivia skipper;
+
+public:
+    lexeme(const P &_parser, const trivia &_skipper = trivia()) : parser(_parser), skipper(_skipper) {}
+    either_of<P> operator()(std::istream &is) const {
+        either_of<P> e = parser(is);
+        if (e.get_mode() == either_mode::right) {
+            skipper(is);
+        }
+        return e;
+    }
+    firsts::first_set first() const { return firsts::first_of(parser); }
+};
+
+} // namespace tokenizes::trivias
@@ -0,0 +1,128 @@
+#include "primitive.hpp"
+#include "trivias.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+using namespace tokenizes::trivias;
+using tokenizes::primitive::tag;
+
+namespace trivia_tests {
+const static trivia skipper;
+
+TEST(trivia, spaces) {
+    std::stringstream ss;
+    ss << " \t\r\n x";
+    EXPECT_TRUE(skipper(ss).is_right());
+    EXPECT_EQ(ss.get(), 'x');
+}
+
+TEST(trivia, none) {
+    std::stringstream ss;
+    ss << "x";
+    EXPECT_TRUE(skipper(ss).is_right());
+    EXPECT_EQ(ss.get(), 'x');
+}
+
+// counts the seeks made through it
+class seek_counting_buffer : public std::stringbuf {
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        seeks++;
+        return std::stringbuf::seekoff(off, dir, which);
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        seeks++;
+        return std::stringbuf::seekpos(pos, which);
+    }
+
+public:
+    using std::stringbuf::stringbuf;
+    int seeks{0};
+};
+
+TEST(trivia, none_without_seeking) {
+    seek_counting_buffer buffer("x/");
+    std::istream is(&buffer);
+    EXPECT_TRUE(skipper(is).is_right());
+    EXPECT_EQ(buffer.seeks, 0);
+    EXPECT_EQ(is.get(), 'x');
+    EXPECT_TRUE(skipper(is).is_right());
+    EXPECT_GT(buffer.seeks, 0); // may open a comment
+    EXPECT_EQ(is.get(), '/');
+}
+
+TEST(trivia, end) {
+    std::stringstream ss;
+    ss << "  ";
+    EXPECT_TRUE(skipper(ss).is_right());
+    EXPECT_EQ(ss.peek(), -1);
+}
+
+TEST(trivia, comments) {
+    std::stringstream ss;
+    ss << "// line\n  /* block\n * / */ // tail\nx";
+    EXPECT_TRUE(skipper(ss).is_right());
+    EXPECT_EQ(ss.get(), 'x');
+}
+
+TEST(trivia, slash) {
+    std::stringstream ss;
+    ss << " / x";
+    EXPECT_TRUE(skipper(ss).is_right());
+    EXPECT_EQ(ss.get(), '/');
+}
+
+TEST(trivia, unterminated) {
+    std::stringstream ss;
+    ss << "  /* open";
+    EXPECT_EQ(skipper(ss).opt_left(), trivia_errors::unterminated_comment);
+    EXPECT_EQ(ss.get(), '/');
+}
+
+TEST(trivia, chunks) {
+    // runs and delimiters straddle every chunk boundary
+    for (size_t pad = trivia::chunk_size - 20; pad < trivia::chunk_size + 4; pad++) {
+        const std::string text = std::string(pad, ' ') + "/* " + std::string(300, '*') + " */" +
+                                 std::string(pad, '\n') + "//" + std::string(pad, '-') + "\nx";
+        std::stringstream ss;
+        ss << text;
+        EXPECT_TRUE(skipper(ss).is_right());
+        EXPECT_EQ(ss.get(), 'x') << pad;
+        EXPECT_EQ(skipper.skip(text), text.size() - 1) << pad;
+    }
+}
+
+TEST(trivia, delimiters) {
+    const trivia hash(tokenizes::primitive::atom(" "), "#", "(*", "*)");
+    std::stringstream ss;
+    ss << "# note\n (* x *) // y";
+    EXPECT_TRUE(hash(ss).is_right());
+    EXPECT_EQ(ss.get(), '/');
+    EXPECT_EQ(hash.skip(" (* x *) //"), 9);
+}
+
+TEST(trivia, disabled) {
+    const trivia spaces_only(tokenizes::primitive::space, "", "", "");
+    EXPECT_EQ(spaces_only.skip("  // x"), 2);
+}
+
+} // namespace trivia_tests
+
+namespace lexeme_tests {
+
+TEST(lexeme, tag) {
+    const auto parser = lexeme(tag("let"));
+    std::stringstream ss;
+    ss << "let /* name */ x";
+    EXPECT_EQ(parser(ss).opt_right(), "let");
+    EXPECT_EQ(ss.get(), 'x');
+}
+
+TEST(lexeme, failed) {
+    const auto parser = lexeme(tag("let"));
+    std::stringstream ss;
+    ss << "var ";
+    EXPECT_TRUE(parser(ss).is_left());
+}
+
+} // namespace lexeme_tests